@@ -24,9 +24,11 @@ typedef libsnark::pb_linear_combination_array<FieldT> LinearCombinationArrayT;
 typedef libsnark::linear_term<FieldT> LinearTermT;
 typedef libsnark::gadget<ethsnarks::FieldT> GadgetT;
 
+typedef libsnark::r1cs_gg_ppzksnark_zok_constraint_system<ppT> ConstraintSystemT;
 typedef libsnark::r1cs_gg_ppzksnark_zok_proof<ppT> ProofT;
 typedef libsnark::r1cs_gg_ppzksnark_zok_proving_key<ppT> ProvingKeyT;
 typedef libsnark::r1cs_gg_ppzksnark_zok_verification_key<ppT> VerificationKeyT;
+typedef libsnark::r1cs_gg_ppzksnark_zok_processed_verification_key<ppT> ProcessedVerificationKeyT;
 typedef libsnark::r1cs_gg_ppzksnark_zok_primary_input<ppT> PrimaryInputT;
 typedef libsnark::r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> AuxiliaryInputT;
 
@@ -7,8 +7,9 @@
 using ethsnarks::ppT;
 using ethsnarks::CircuitReader;
 using ethsnarks::ProtoboardT;
+using ethsnarks::ConstraintSystemT;
 using ethsnarks::stub_prove_from_pb;
-using ethsnarks::stub_genkeys_from_pb;
+using ethsnarks::stub_genkeys_from_cs;
 using ethsnarks::stub_main_verify;
 
 using std::ofstream;
@@ -18,15 +19,27 @@ using std::endl;
 using std::string;
 
 
-static int main_genkeys( ProtoboardT& pb, const char *arith_file, const char *pk_raw, const char *vk_json )
+static int main_genkeys( const char *arith_file, const char *pk_raw, const char *vk_json )
 {
-	CircuitReader circuit(pb, arith_file, nullptr);
+	// Without inputs no witness is computed, and checking the all-zero
+	// assignment against the constraints would only cost time. The
+	// protoboard and circuit are released before the keys are generated.
+	ConstraintSystemT constraints;
+	{
+		libff::enter_block("Read circuit");
+		ProtoboardT pb;
+		CircuitReader circuit(pb, arith_file, nullptr);
+		constraints = pb.get_constraint_system();
+		libff::leave_block("Read circuit");
+	}
 
-	if( ! pb.is_satisfied() ) {
-		cerr << "Error: not satisfied!" << endl;
+	if( ! libff::inhibit_profiling_info )
+	{
+		libff::print_indent();
+		printf("* Skipped satisfaction check: %zu constraints\n", constraints.num_constraints());
 	}
 
-	return stub_genkeys_from_pb(pb, pk_raw, vk_json);
+	return stub_genkeys_from_cs(std::move(constraints), pk_raw, vk_json);
 }
 
 
@@ -107,7 +120,7 @@ int main(int argc, char **argv)
 		}
 		const char *pk_raw = sub_argv[0];
 		const char *vk_json = sub_argv[1];
-		return main_genkeys(pb, arith_file, pk_raw, vk_json );
+		return main_genkeys(arith_file, pk_raw, vk_json );
 	}
 	else if( cmd == "prove" ) {
 		if( sub_argc < 3 ) {
@@ -0,0 +1,42 @@
+/** @file
+ *****************************************************************************
+
+ Declaration of interfaces for reserving large buffers on huge pages.
+
+ A buffer of a few hundred MB touched for the first time takes one page
+ fault per 4 KiB page. With transparent huge pages (Linux) the kernel can
+ back it with 2 MiB pages instead, which also takes far fewer TLB entries
+ when the buffer is then swept by FFTs and multi-exponentiations. The
+ kernel only does so for memory marked with madvise(MADV_HUGEPAGE) when
+ THP is in "madvise" mode, which is the default of most distributions.
+
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef HUGE_PAGES_HPP_
+#define HUGE_PAGES_HPP_
+
+#include <cstddef>
+#include <vector>
+
+namespace libsnark {
+
+/**
+ * Makes sure `v` can hold `n` elements without being reallocated.
+ *
+ * When new storage has to be allocated and `v` is empty, the huge pages
+ * it spans are marked for transparent huge pages before anything is
+ * written to them. This is only advice: the call never fails because of
+ * it, and does nothing more than reserve() on other systems.
+ */
+template<typename T>
+void reserve_huge_pages(std::vector<T> &v, const size_t n);
+
+} // libsnark
+
+#include "r1cs_gg_ppzksnark_zok/huge_pages.tcc"
+
+#endif // HUGE_PAGES_HPP_
@@ -0,0 +1,62 @@
+/** @file
+ *****************************************************************************
+
+ Implementation of interfaces for reserving large buffers on huge pages.
+
+ See huge_pages.hpp .
+
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef HUGE_PAGES_TCC_
+#define HUGE_PAGES_TCC_
+
+#include <cstdint>
+
+#include <libff/common/utils.hpp>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace libsnark {
+
+template<typename T>
+void reserve_huge_pages(std::vector<T> &v, const size_t n)
+{
+    if (v.capacity() >= n)
+    {
+        return;
+    }
+
+    /* Elements already in `v` are copied to the new storage by reserve(),
+       touching its pages before they could be marked */
+    const bool fresh = v.empty();
+    v.reserve(n);
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (fresh)
+    {
+        const uintptr_t huge_page_size = 1ul << 21;
+        const uintptr_t begin = reinterpret_cast<uintptr_t>(v.data());
+        const uintptr_t end = begin + v.capacity() * sizeof(T);
+
+        /* madvise needs page-aligned bounds, only whole huge pages matter */
+        const uintptr_t huge_begin = (begin + huge_page_size - 1) & ~(huge_page_size - 1);
+        const uintptr_t huge_end = end & ~(huge_page_size - 1);
+        if (huge_begin < huge_end)
+        {
+            madvise(reinterpret_cast<void*>(huge_begin), huge_end - huge_begin, MADV_HUGEPAGE);
+        }
+    }
+#else
+    libff::UNUSED(fresh);
+#endif
+}
+
+} // libsnark
+
+#endif // HUGE_PAGES_TCC_
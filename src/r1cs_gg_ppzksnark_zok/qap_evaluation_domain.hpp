@@ -0,0 +1,74 @@
+/** @file
+ *****************************************************************************
+
+ Declaration of interfaces for the evaluation domain used to compute H.
+
+ The domain is the one chosen by libfqfft::get_evaluation_domain, so that H
+ matches the H-query of the proving key. When it is a plain radix-2 domain
+ (the size is a power of two), the twiddle factors, the powers of the coset
+ generator and the inverse of Z on the coset can be computed once and kept;
+ the transforms then only read them instead of recomputing roots of unity
+ on every call. Other domains are left to libfqfft.
+
+ Keeping the tables costs about 3m field elements for a domain of size m.
+
+ With the tables, the transforms use a radix-4 FFT: the bit-reversal
+ permutation swaps 16x16 tiles so that every access is to a run of
+ consecutive elements, the stages whose groups fit in the L2 cache are all
+ done one cache-sized block at a time (in parallel across blocks), and
+ the remaining stages run as whole-vector passes split across threads,
+ two radix-2 stages per pass.
+
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef QAP_EVALUATION_DOMAIN_HPP_
+#define QAP_EVALUATION_DOMAIN_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <libfqfft/evaluation_domain/evaluation_domain.hpp>
+
+namespace libsnark {
+
+template<typename FieldT>
+class qap_evaluation_domain {
+public:
+    std::shared_ptr<libfqfft::evaluation_domain<FieldT> > domain;
+    size_t m;
+
+    /* Only filled for radix-2 domains built with precompute_tables set */
+    bool has_tables;
+    std::vector<FieldT> twiddles;             // omega^i, for i < m/2
+    std::vector<FieldT> inverse_twiddles;     // omega^{-i}, for i < m/2
+    std::vector<FieldT> coset_powers;         // g^i, for i < m
+    std::vector<FieldT> inverse_coset_powers; // g^{-i} / m, for i < m
+    FieldT m_inverse;
+    FieldT Z_inverse_at_coset;
+
+    qap_evaluation_domain(const size_t min_size, const bool precompute_tables);
+
+    size_t tables_size_in_bytes() const;
+
+    /* Same results as the libfqfft methods of the same name, with the coset
+       generator FieldT::multiplicative_generator */
+    void FFT(std::vector<FieldT> &a) const;
+    void iFFT(std::vector<FieldT> &a) const;
+    void cosetFFT(std::vector<FieldT> &a) const;
+    void icosetFFT(std::vector<FieldT> &a) const;
+    void divide_by_Z_on_coset(std::vector<FieldT> &P) const;
+
+private:
+    void radix4_FFT(std::vector<FieldT> &a, const std::vector<FieldT> &roots) const;
+};
+
+} // libsnark
+
+#include "r1cs_gg_ppzksnark_zok/qap_evaluation_domain.tcc"
+
+#endif // QAP_EVALUATION_DOMAIN_HPP_
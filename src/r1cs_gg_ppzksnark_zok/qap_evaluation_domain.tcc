@@ -0,0 +1,378 @@
+/** @file
+ *****************************************************************************
+
+ Implementation of interfaces for the evaluation domain used to compute H.
+
+ See qap_evaluation_domain.hpp .
+
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef QAP_EVALUATION_DOMAIN_TCC_
+#define QAP_EVALUATION_DOMAIN_TCC_
+
+#include <algorithm>
+#include <cassert>
+
+#ifdef MULTICORE
+#include <omp.h>
+#endif
+
+#include <libff/algebra/fields/field_utils.hpp>
+#include <libff/common/utils.hpp>
+#include <libfqfft/evaluation_domain/get_evaluation_domain.hpp>
+
+namespace libsnark {
+
+/**
+ * Sets powers[i] = scale * base^i for i < n, each thread starting its range
+ * from one exponentiation.
+ */
+template<typename FieldT>
+void qap_evaluation_domain_powers(std::vector<FieldT> &powers, const size_t n, const FieldT &base, const FieldT &scale)
+{
+    powers.resize(n);
+
+#ifdef MULTICORE
+    const size_t num_ranges = std::max<size_t>(1, std::min<size_t>(omp_get_max_threads(), n));
+#else
+    const size_t num_ranges = 1;
+#endif
+
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
+    for (size_t r = 0; r < num_ranges; ++r)
+    {
+        const size_t begin = n * r / num_ranges;
+        const size_t end = n * (r + 1) / num_ranges;
+
+        FieldT power = scale * (base ^ begin);
+        for (size_t i = begin; i < end; ++i)
+        {
+            powers[i] = power;
+            power *= base;
+        }
+    }
+}
+
+template<typename FieldT>
+qap_evaluation_domain<FieldT>::qap_evaluation_domain(const size_t min_size, const bool precompute_tables) :
+    domain(libfqfft::get_evaluation_domain<FieldT>(min_size)),
+    m(domain->m),
+    has_tables(false)
+{
+    /* get_evaluation_domain returns a basic radix-2 domain whenever the size
+       is a power of two that the field supports */
+    const size_t log_m = libff::log2(m);
+    const bool is_radix2 = (m > 1 && m == (1ul << log_m) && log_m <= FieldT::s);
+
+    if (!precompute_tables || !is_radix2)
+    {
+        return;
+    }
+
+    const FieldT omega = libff::get_root_of_unity<FieldT>(m);
+    const FieldT g = FieldT::multiplicative_generator;
+
+    this->m_inverse = FieldT(m).inverse();
+    this->Z_inverse_at_coset = ((g ^ m) - FieldT::one()).inverse();
+
+    qap_evaluation_domain_powers(this->twiddles, m / 2, omega, FieldT::one());
+    qap_evaluation_domain_powers(this->inverse_twiddles, m / 2, omega.inverse(), FieldT::one());
+    qap_evaluation_domain_powers(this->coset_powers, m, g, FieldT::one());
+    qap_evaluation_domain_powers(this->inverse_coset_powers, m, g.inverse(), this->m_inverse);
+
+    this->has_tables = true;
+}
+
+template<typename FieldT>
+size_t qap_evaluation_domain<FieldT>::tables_size_in_bytes() const
+{
+    return (twiddles.size() + inverse_twiddles.size() + coset_powers.size() + inverse_coset_powers.size()) * sizeof(FieldT);
+}
+
+/**
+ * Number of elements, a power of two, of the blocks in which the first FFT
+ * stages are done: the largest one fitting in a 256 KiB L2 cache.
+ */
+template<typename FieldT>
+size_t qap_evaluation_domain_block_size()
+{
+    size_t block_size = 1;
+    while (2 * block_size * sizeof(FieldT) <= (1ul << 18))
+    {
+        block_size *= 2;
+    }
+
+    return block_size;
+}
+
+/**
+ * Bit-reversal permutation of `a`, of size 2^log_m.
+ *
+ * Indices are split as (hi, mid, lo) with hi and lo of 4 bits; for a given
+ * mid the indices (hi, mid, *) and their images (rev(lo), rev(mid), *) form
+ * two 16x16 tiles of runs of consecutive elements, which are swapped with
+ * each other.
+ */
+template<typename FieldT>
+void qap_evaluation_domain_bit_reverse(std::vector<FieldT> &a, const size_t log_m)
+{
+    const size_t m = 1ul << log_m;
+    const size_t tile_bits = 4;
+
+    if (log_m < 2 * tile_bits)
+    {
+        for (size_t k = 0; k < m; ++k)
+        {
+            const size_t rk = libff::bitreverse(k, log_m);
+            if (k < rk)
+            {
+                std::swap(a[k], a[rk]);
+            }
+        }
+        return;
+    }
+
+    const size_t tile = 1ul << tile_bits;
+    const size_t mid_bits = log_m - 2 * tile_bits;
+    const size_t hi_shift = log_m - tile_bits;
+
+    size_t rev_tile[tile];
+    for (size_t i = 0; i < tile; ++i)
+    {
+        rev_tile[i] = libff::bitreverse(i, tile_bits);
+    }
+
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
+    for (size_t mid = 0; mid < (1ul << mid_bits); ++mid)
+    {
+        const size_t rev_mid = libff::bitreverse(mid, mid_bits);
+        if (rev_mid < mid)
+        {
+            continue;
+        }
+
+        for (size_t hi = 0; hi < tile; ++hi)
+        {
+            for (size_t lo = 0; lo < tile; ++lo)
+            {
+                const size_t k = (hi << hi_shift) | (mid << tile_bits) | lo;
+                const size_t rk = (rev_tile[lo] << hi_shift) | (rev_mid << tile_bits) | rev_tile[hi];
+                if (mid < rev_mid || k < rk)
+                {
+                    std::swap(a[k], a[rk]);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * The radix-2 stages of half sizes h and 2h on a[k], a[k+h], a[k+2h] and
+ * a[k+3h], with twiddles w1 for the first stage and w2, w3 for the pairs
+ * (k, k+2h) and (k+h, k+3h) of the second.
+ */
+template<typename FieldT>
+inline void qap_evaluation_domain_radix4_butterfly(FieldT *a, const size_t k, const size_t h,
+                                                   const FieldT &w1, const FieldT &w2, const FieldT &w3)
+{
+    const FieldT t1 = w1 * a[k + h];
+    const FieldT t3 = w1 * a[k + 3 * h];
+
+    const FieldT b0 = a[k] + t1;
+    const FieldT b1 = a[k] - t1;
+    const FieldT b2 = a[k + 2 * h] + t3;
+    const FieldT b3 = a[k + 2 * h] - t3;
+
+    const FieldT u2 = w2 * b2;
+    const FieldT u3 = w3 * b3;
+
+    a[k] = b0 + u2;
+    a[k + 2 * h] = b0 - u2;
+    a[k + h] = b1 + u3;
+    a[k + 3 * h] = b1 - u3;
+}
+
+/**
+ * Butterflies [begin, end) of the radix-4 pass of half size h over a vector
+ * of size m.
+ */
+template<typename FieldT>
+void qap_evaluation_domain_radix4_pass(FieldT *a, const size_t begin, const size_t end,
+                                       const size_t h, const FieldT *roots, const size_t m)
+{
+    const size_t step1 = m / (2 * h);
+    const size_t step2 = m / (4 * h);
+
+    for (size_t t = begin; t < end; ++t)
+    {
+        const size_t j = t % h;
+        const size_t k = (t - j) * 4 + j;
+        qap_evaluation_domain_radix4_butterfly(a, k, h, roots[j * step1], roots[j * step2], roots[(j + h) * step2]);
+    }
+}
+
+template<typename FieldT>
+void qap_evaluation_domain<FieldT>::radix4_FFT(std::vector<FieldT> &a, const std::vector<FieldT> &roots) const
+{
+    assert(a.size() == m);
+    const size_t log_m = libff::log2(m);
+    FieldT *data = a.data();
+    const FieldT *root = roots.data();
+
+    qap_evaluation_domain_bit_reverse(a, log_m);
+
+    /* Stages whose groups of 4h elements fit in a block are done block by
+       block, each block staying in cache */
+    const size_t block_size = std::min(m, qap_evaluation_domain_block_size<FieldT>());
+    size_t block_h_end = 1;
+    while (4 * block_h_end <= block_size)
+    {
+        block_h_end *= 4;
+    }
+
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
+    for (size_t b = 0; b < m / block_size; ++b)
+    {
+        for (size_t h = 1; h < block_h_end; h *= 4)
+        {
+            qap_evaluation_domain_radix4_pass(data, b * block_size / 4, (b + 1) * block_size / 4, h, root, m);
+        }
+    }
+
+    /* Larger stages run over the whole vector */
+    size_t h = block_h_end;
+    for (; 4 * h <= m; h *= 4)
+    {
+        const size_t step1 = m / (2 * h);
+        const size_t step2 = m / (4 * h);
+
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
+        for (size_t t = 0; t < m / 4; ++t)
+        {
+            const size_t j = t % h;
+            const size_t k = (t - j) * 4 + j;
+            qap_evaluation_domain_radix4_butterfly(data, k, h, root[j * step1], root[j * step2], root[(j + h) * step2]);
+        }
+    }
+
+    /* One radix-2 stage is left when log m is odd */
+    if (2 * h == m)
+    {
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
+        for (size_t j = 0; j < h; ++j)
+        {
+            const FieldT t = root[j] * data[j + h];
+            data[j + h] = data[j] - t;
+            data[j] += t;
+        }
+    }
+}
+
+template<typename FieldT>
+void qap_evaluation_domain<FieldT>::FFT(std::vector<FieldT> &a) const
+{
+    if (!has_tables)
+    {
+        domain->FFT(a);
+        return;
+    }
+
+    radix4_FFT(a, twiddles);
+}
+
+template<typename FieldT>
+void qap_evaluation_domain<FieldT>::iFFT(std::vector<FieldT> &a) const
+{
+    if (!has_tables)
+    {
+        domain->iFFT(a);
+        return;
+    }
+
+    radix4_FFT(a, inverse_twiddles);
+
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
+    for (size_t i = 0; i < m; ++i)
+    {
+        a[i] *= m_inverse;
+    }
+}
+
+template<typename FieldT>
+void qap_evaluation_domain<FieldT>::cosetFFT(std::vector<FieldT> &a) const
+{
+    if (!has_tables)
+    {
+        domain->cosetFFT(a, FieldT::multiplicative_generator);
+        return;
+    }
+
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
+    for (size_t i = 0; i < m; ++i)
+    {
+        a[i] *= coset_powers[i];
+    }
+
+    radix4_FFT(a, twiddles);
+}
+
+template<typename FieldT>
+void qap_evaluation_domain<FieldT>::icosetFFT(std::vector<FieldT> &a) const
+{
+    if (!has_tables)
+    {
+        domain->icosetFFT(a, FieldT::multiplicative_generator);
+        return;
+    }
+
+    radix4_FFT(a, inverse_twiddles);
+
+    /* The 1/m of the inverse transform is folded into the coset powers */
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
+    for (size_t i = 0; i < m; ++i)
+    {
+        a[i] *= inverse_coset_powers[i];
+    }
+}
+
+template<typename FieldT>
+void qap_evaluation_domain<FieldT>::divide_by_Z_on_coset(std::vector<FieldT> &P) const
+{
+    if (!has_tables)
+    {
+        domain->divide_by_Z_on_coset(P);
+        return;
+    }
+
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
+    for (size_t i = 0; i < m; ++i)
+    {
+        P[i] *= Z_inverse_at_coset;
+    }
+}
+
+} // libsnark
+
+#endif // QAP_EVALUATION_DOMAIN_TCC_
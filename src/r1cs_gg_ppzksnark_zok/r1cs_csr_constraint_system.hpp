@@ -0,0 +1,199 @@
+/** @file
+ *****************************************************************************
+
+ Declaration of interfaces for an R1CS stored as three sparse matrices.
+
+ The prover only needs the products A*z, B*z and C*z of the constraint
+ matrices with the padded assignment z = (1, x_1, ..., x_n). Every matrix is
+ kept in compressed sparse row (CSR) form: the terms of row i are
+ [row_offsets[i], row_offsets[i+1]), each term being a column of z and the
+ index of its coefficient in a table of the distinct coefficients of the
+ matrix. Coefficients of real circuits are mostly 1, -1 and small powers of
+ two, so the table stays tiny and a term takes 8 bytes instead of a
+ variable index plus a field element, without any per-constraint
+ allocations or annotations.
+
+ The QAP witness map below is the one of r1cs_to_qap.hpp (without the
+ zero-knowledge patch, which the GG-ppzkSNARK does not use) evaluated over
+ these matrices. So is the instance map evaluated at a point, which the
+ generator needs: A_j(t) is column j of A times the Lagrange polynomials
+ at t, and the columns are summed in parallel over a transposed copy of
+ the terms.
+
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef R1CS_CSR_CONSTRAINT_SYSTEM_HPP_
+#define R1CS_CSR_CONSTRAINT_SYSTEM_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include <libff/common/utils.hpp>
+#include <libsnark/relations/arithmetic_programs/qap/qap.hpp>
+#include <libsnark/relations/constraint_satisfaction_problems/r1cs/r1cs.hpp>
+#include "r1cs_gg_ppzksnark_zok/huge_pages.hpp"
+#include "r1cs_gg_ppzksnark_zok/qap_evaluation_domain.hpp"
+#include "r1cs_gg_ppzksnark_zok/r1cs_padded_assignment.hpp"
+
+namespace libsnark {
+
+template<typename FieldT>
+class r1cs_csr_matrix;
+
+template<typename FieldT>
+std::ostream& operator<<(std::ostream &out, const r1cs_csr_matrix<FieldT> &matrix);
+
+template<typename FieldT>
+std::istream& operator>>(std::istream &in, r1cs_csr_matrix<FieldT> &matrix);
+
+/**
+ * One of the A, B or C matrices of an R1CS, in CSR form.
+ *
+ * Column 0 is the constant term, column j > 0 the variable x_j. Coefficient
+ * index 0 always refers to FieldT::one().
+ */
+template<typename FieldT>
+class r1cs_csr_matrix {
+public:
+    std::vector<size_t> row_offsets;
+    std::vector<uint32_t> columns;
+    std::vector<uint32_t> coefficient_indices;
+    std::vector<FieldT> coefficients;
+
+    r1cs_csr_matrix();
+
+    size_t num_rows() const { return row_offsets.size() - 1; }
+    size_t num_nonzero() const { return columns.size(); }
+    size_t size_in_bytes() const;
+
+    /* Returns row `i` times the padded assignment `z`, either a vector or
+       an r1cs_padded_assignment */
+    template<typename Assignment>
+    FieldT evaluate_row(const size_t i, const Assignment &z) const;
+
+    /* Writes row i times `z` to result[i], for every row, using up to
+       `chunks` threads */
+    template<typename Assignment>
+    void multiply(const Assignment &z,
+                  typename std::vector<FieldT>::iterator result,
+                  const size_t chunks) const;
+
+    /* Adds the dot product of column j and `u` to result[j], for every
+       column j below result.size(), using up to `chunks` threads. Sets
+       (*density)[j] when result[j] is then not zero, if `density` is not
+       null, and returns the number of such columns */
+    size_t accumulate_columns(const std::vector<FieldT> &u,
+                              std::vector<FieldT> &result,
+                              libff::bit_vector *density,
+                              const size_t chunks) const;
+
+    /* Throws std::invalid_argument unless the rows are well formed and
+       every term refers to a column below `num_columns` and to a
+       coefficient of the table */
+    void validate(const size_t num_columns) const;
+
+    bool operator==(const r1cs_csr_matrix<FieldT> &other) const;
+    friend std::ostream& operator<< <FieldT>(std::ostream &out, const r1cs_csr_matrix<FieldT> &matrix);
+    friend std::istream& operator>> <FieldT>(std::istream &in, r1cs_csr_matrix<FieldT> &matrix);
+};
+
+template<typename FieldT>
+class r1cs_csr_constraint_system;
+
+template<typename FieldT>
+std::ostream& operator<<(std::ostream &out, const r1cs_csr_constraint_system<FieldT> &cs);
+
+template<typename FieldT>
+std::istream& operator>>(std::istream &in, r1cs_csr_constraint_system<FieldT> &cs);
+
+/**
+ * The constraint matrices of an R1CS, with the sizes of its inputs.
+ */
+template<typename FieldT>
+class r1cs_csr_constraint_system {
+public:
+    size_t primary_input_size;
+    size_t auxiliary_input_size;
+
+    r1cs_csr_matrix<FieldT> A;
+    r1cs_csr_matrix<FieldT> B;
+    r1cs_csr_matrix<FieldT> C;
+
+    r1cs_csr_constraint_system() : primary_input_size(0), auxiliary_input_size(0) {};
+    explicit r1cs_csr_constraint_system(const r1cs_constraint_system<FieldT> &cs);
+
+    size_t num_inputs() const { return primary_input_size; }
+    size_t num_variables() const { return primary_input_size + auxiliary_input_size; }
+    size_t num_constraints() const { return A.num_rows(); }
+    size_t size_in_bytes() const { return A.size_in_bytes() + B.size_in_bytes() + C.size_in_bytes(); }
+
+    bool is_satisfied(const r1cs_primary_input<FieldT> &primary_input,
+                      const r1cs_auxiliary_input<FieldT> &auxiliary_input) const;
+
+    /* Throws std::invalid_argument unless A, B and C are valid over the
+       variables and have one row per constraint; matrices read from an
+       untrusted key are checked before they are evaluated */
+    void validate() const;
+
+    void print_size() const;
+
+    bool operator==(const r1cs_csr_constraint_system<FieldT> &other) const;
+    friend std::ostream& operator<< <FieldT>(std::ostream &out, const r1cs_csr_constraint_system<FieldT> &cs);
+    friend std::istream& operator>> <FieldT>(std::istream &in, r1cs_csr_constraint_system<FieldT> &cs);
+};
+
+/**
+ * Witness map for the QAP of `cs`, as r1cs_to_qap_witness_map with
+ * d1 = d2 = d3 = 0.
+ */
+template<typename FieldT>
+qap_witness<FieldT> r1cs_csr_to_qap_witness_map(const r1cs_csr_constraint_system<FieldT> &cs,
+                                                const r1cs_primary_input<FieldT> &primary_input,
+                                                const r1cs_auxiliary_input<FieldT> &auxiliary_input);
+
+/**
+ * As above, over a domain prepared beforehand for the size of `cs`.
+ */
+template<typename FieldT>
+qap_witness<FieldT> r1cs_csr_to_qap_witness_map(const r1cs_csr_constraint_system<FieldT> &cs,
+                                                const r1cs_primary_input<FieldT> &primary_input,
+                                                const r1cs_auxiliary_input<FieldT> &auxiliary_input,
+                                                const qap_evaluation_domain<FieldT> &domain);
+
+/**
+ * Instance map for the QAP of `cs` evaluated at `t`, as
+ * r1cs_to_qap_instance_map_with_evaluation. At_density[i] and Bt_density[i]
+ * are set when A_i(t) and B_i(t) are not zero, for every variable i.
+ */
+template<typename FieldT>
+qap_instance_evaluation<FieldT> r1cs_csr_to_qap_instance_map_with_evaluation(const r1cs_csr_constraint_system<FieldT> &cs,
+                                                                             const FieldT &t,
+                                                                             libff::bit_vector &At_density,
+                                                                             libff::bit_vector &Bt_density);
+
+/**
+ * The part of the witness map the prover needs: writes the m+1
+ * coefficients of H for the padded assignment z = (1, x_1, ..., x_n) to
+ * `H`, using `scratch` for the evaluations of B and C.
+ *
+ * Both vectors are overwritten but keep their capacity, so buffers reused
+ * from one call to the next are only allocated once.
+ */
+template<typename FieldT>
+void r1cs_csr_to_qap_H_coefficients(const r1cs_csr_constraint_system<FieldT> &cs,
+                                    const r1cs_padded_assignment<FieldT> &z,
+                                    const qap_evaluation_domain<FieldT> &domain,
+                                    std::vector<FieldT> &H,
+                                    std::vector<FieldT> &scratch);
+
+} // libsnark
+
+#include "r1cs_gg_ppzksnark_zok/r1cs_csr_constraint_system.tcc"
+
+#endif // R1CS_CSR_CONSTRAINT_SYSTEM_HPP_
@@ -0,0 +1,698 @@
+/** @file
+ *****************************************************************************
+
+ Implementation of interfaces for an R1CS stored as three sparse matrices.
+
+ See r1cs_csr_constraint_system.hpp .
+
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef R1CS_CSR_CONSTRAINT_SYSTEM_TCC_
+#define R1CS_CSR_CONSTRAINT_SYSTEM_TCC_
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <limits>
+#include <map>
+#include <stdexcept>
+
+#include <libff/common/profiling.hpp>
+#include <libff/common/serialization.hpp>
+
+#ifdef MULTICORE
+#include <omp.h>
+#endif
+
+namespace libsnark {
+
+/**
+ * Index arrays are written as text, or as raw memory when BINARY_OUTPUT is
+ * set, like the field elements around them.
+ */
+template<typename T>
+void r1cs_csr_write_indices(std::ostream &out, const std::vector<T> &v)
+{
+    out << v.size() << "\n";
+#ifdef BINARY_OUTPUT
+    out.write(reinterpret_cast<const char *>(v.data()), v.size() * sizeof(T));
+#else
+    for (const T &x : v)
+    {
+        out << x << "\n";
+    }
+#endif
+}
+
+/**
+ * Bytes left to read from `in`, or the largest size_t when the stream
+ * cannot tell.
+ */
+inline size_t r1cs_csr_remaining_bytes(std::istream &in)
+{
+    const std::istream::pos_type position = in.tellg();
+    if (position == std::istream::pos_type(-1))
+    {
+        in.clear(in.rdstate() & ~std::ios::failbit);
+        return std::numeric_limits<size_t>::max();
+    }
+
+    in.seekg(0, std::ios::end);
+    const std::istream::pos_type end = in.tellg();
+    in.seekg(position);
+
+    return (end == std::istream::pos_type(-1) || end < position) ? 0 : size_t(end - position);
+}
+
+template<typename T>
+void r1cs_csr_read_indices(std::istream &in, std::vector<T> &v)
+{
+    size_t size;
+    in >> size;
+    libff::consume_newline(in);
+
+    /* The size comes from the stream, it is checked against the bytes
+       left, each element taking at least sizeof(T) bytes in binary or a
+       digit and a newline in text, before anything is allocated for it */
+#ifdef BINARY_OUTPUT
+    const size_t min_element_bytes = sizeof(T);
+#else
+    const size_t min_element_bytes = 2;
+#endif
+    if (!in || size > r1cs_csr_remaining_bytes(in) / min_element_bytes)
+    {
+        in.setstate(std::ios::failbit);
+        v.clear();
+        return;
+    }
+
+    v.resize(size);
+#ifdef BINARY_OUTPUT
+    in.read(reinterpret_cast<char *>(v.data()), size * sizeof(T));
+#else
+    for (size_t i = 0; i < size; ++i)
+    {
+        in >> v[i];
+        libff::consume_newline(in);
+    }
+#endif
+}
+
+template<typename FieldT>
+r1cs_csr_matrix<FieldT>::r1cs_csr_matrix() :
+    row_offsets(1, 0),
+    coefficients(1, FieldT::one())
+{
+}
+
+template<typename FieldT>
+size_t r1cs_csr_matrix<FieldT>::size_in_bytes() const
+{
+    return (row_offsets.size() * sizeof(size_t) +
+            columns.size() * sizeof(uint32_t) +
+            coefficient_indices.size() * sizeof(uint32_t) +
+            coefficients.size() * sizeof(FieldT));
+}
+
+template<typename FieldT>
+template<typename Assignment>
+FieldT r1cs_csr_matrix<FieldT>::evaluate_row(const size_t i, const Assignment &z) const
+{
+    const uint32_t *column = columns.data();
+    const uint32_t *coefficient_index = coefficient_indices.data();
+    const FieldT *coefficient = coefficients.data();
+
+    FieldT acc = FieldT::zero();
+    for (size_t k = row_offsets[i]; k < row_offsets[i+1]; ++k)
+    {
+        const uint32_t c = coefficient_index[k];
+        if (c == 0)
+        {
+            acc += z[column[k]];
+        }
+        else
+        {
+            acc += coefficient[c] * z[column[k]];
+        }
+    }
+
+    return acc;
+}
+
+template<typename FieldT>
+template<typename Assignment>
+void r1cs_csr_matrix<FieldT>::multiply(const Assignment &z,
+                                       typename std::vector<FieldT>::iterator result,
+                                       const size_t chunks) const
+{
+    const size_t rows = num_rows();
+    const size_t num_threads = std::max<size_t>(chunks, 1);
+
+    /* Rows are split into parts holding about the same number of terms, a
+       few per thread so that dynamic scheduling can even out the cost of
+       the rows with non-unit coefficients */
+    const size_t num_parts = std::min(rows, 4 * num_threads);
+    std::vector<size_t> part_starts(num_parts + 1, rows);
+    for (size_t p = 0; p < num_parts; ++p)
+    {
+        const size_t target = num_nonzero() * p / num_parts;
+        const size_t start = std::upper_bound(row_offsets.begin(), row_offsets.end(), target) - row_offsets.begin() - 1;
+        part_starts[p] = (p == 0) ? 0 : start;
+    }
+
+#ifdef MULTICORE
+#pragma omp parallel for schedule(dynamic) num_threads(num_threads)
+#endif
+    for (size_t p = 0; p < num_parts; ++p)
+    {
+        for (size_t i = part_starts[p]; i < part_starts[p+1]; ++i)
+        {
+            result[i] = evaluate_row(i, z);
+        }
+    }
+}
+
+template<typename FieldT>
+size_t r1cs_csr_matrix<FieldT>::accumulate_columns(const std::vector<FieldT> &u,
+                                                   std::vector<FieldT> &result,
+                                                   libff::bit_vector *density,
+                                                   const size_t chunks) const
+{
+    const size_t rows = num_rows();
+    const size_t num_columns = result.size();
+    const size_t num_threads = std::max<size_t>(chunks, 1);
+    assert(u.size() >= rows);
+    assert(rows <= std::numeric_limits<uint32_t>::max());
+
+    /* Transpose the terms with a counting sort: those of column j are
+       [column_offsets[j], column_offsets[j+1]) of term_rows and
+       term_coefficients */
+    std::vector<size_t> column_offsets(num_columns + 1, 0);
+    for (const uint32_t column : columns)
+    {
+        assert(column < num_columns);
+        ++column_offsets[column + 1];
+    }
+    for (size_t j = 0; j < num_columns; ++j)
+    {
+        column_offsets[j + 1] += column_offsets[j];
+    }
+
+    std::vector<uint32_t> term_rows(num_nonzero());
+    std::vector<uint32_t> term_coefficients(num_nonzero());
+    {
+        std::vector<size_t> next(column_offsets.begin(), column_offsets.end() - 1);
+        for (size_t i = 0; i < rows; ++i)
+        {
+            for (size_t k = row_offsets[i]; k < row_offsets[i+1]; ++k)
+            {
+                const size_t position = next[columns[k]]++;
+                term_rows[position] = i;
+                term_coefficients[position] = coefficient_indices[k];
+            }
+        }
+    }
+
+    /* Columns are split into parts holding about the same number of
+       terms, as rows are in multiply(). Parts start at multiples of 64
+       columns, so that no two threads write to the same word of
+       `density` */
+    const size_t num_parts = std::min((num_columns + 63) / 64, 4 * num_threads);
+    std::vector<size_t> part_starts(num_parts + 1, num_columns);
+    for (size_t p = 0; p < num_parts; ++p)
+    {
+        const size_t target = num_nonzero() * p / num_parts;
+        const size_t start = std::upper_bound(column_offsets.begin(), column_offsets.end(), target) - column_offsets.begin() - 1;
+        part_starts[p] = (p == 0) ? 0 : std::min(start / 64 * 64, num_columns);
+    }
+
+    if (density != nullptr)
+    {
+        density->assign(num_columns, false);
+    }
+
+    const FieldT *coefficient = coefficients.data();
+    size_t num_nonzero_columns = 0;
+
+#ifdef MULTICORE
+#pragma omp parallel for schedule(dynamic) num_threads(num_threads) reduction(+:num_nonzero_columns)
+#endif
+    for (size_t p = 0; p < num_parts; ++p)
+    {
+        for (size_t j = part_starts[p]; j < part_starts[p+1]; ++j)
+        {
+            FieldT acc = result[j];
+            for (size_t k = column_offsets[j]; k < column_offsets[j+1]; ++k)
+            {
+                const uint32_t c = term_coefficients[k];
+                if (c == 0)
+                {
+                    acc += u[term_rows[k]];
+                }
+                else
+                {
+                    acc += u[term_rows[k]] * coefficient[c];
+                }
+            }
+            result[j] = acc;
+
+            if (!acc.is_zero())
+            {
+                ++num_nonzero_columns;
+                if (density != nullptr)
+                {
+                    (*density)[j] = true;
+                }
+            }
+        }
+    }
+
+    return num_nonzero_columns;
+}
+
+template<typename FieldT>
+void r1cs_csr_matrix<FieldT>::validate(const size_t num_columns) const
+{
+    if (row_offsets.empty() || row_offsets[0] != 0 || row_offsets.back() != columns.size() ||
+        coefficient_indices.size() != columns.size() || coefficients.empty() ||
+        num_rows() > std::numeric_limits<uint32_t>::max())
+    {
+        throw std::invalid_argument("r1cs_csr_matrix: the rows do not cover the terms");
+    }
+
+    for (size_t i = 0; i < num_rows(); ++i)
+    {
+        if (row_offsets[i] > row_offsets[i+1])
+        {
+            throw std::invalid_argument("r1cs_csr_matrix: the row offsets decrease");
+        }
+    }
+
+    for (size_t k = 0; k < columns.size(); ++k)
+    {
+        if (columns[k] >= num_columns || coefficient_indices[k] >= coefficients.size())
+        {
+            throw std::invalid_argument("r1cs_csr_matrix: a term is out of the columns or the coefficients");
+        }
+    }
+}
+
+template<typename FieldT>
+bool r1cs_csr_matrix<FieldT>::operator==(const r1cs_csr_matrix<FieldT> &other) const
+{
+    return (this->row_offsets == other.row_offsets &&
+            this->columns == other.columns &&
+            this->coefficient_indices == other.coefficient_indices &&
+            this->coefficients == other.coefficients);
+}
+
+template<typename FieldT>
+std::ostream& operator<<(std::ostream &out, const r1cs_csr_matrix<FieldT> &matrix)
+{
+    r1cs_csr_write_indices(out, matrix.row_offsets);
+    r1cs_csr_write_indices(out, matrix.columns);
+    r1cs_csr_write_indices(out, matrix.coefficient_indices);
+    out << matrix.coefficients;
+
+    return out;
+}
+
+template<typename FieldT>
+std::istream& operator>>(std::istream &in, r1cs_csr_matrix<FieldT> &matrix)
+{
+    r1cs_csr_read_indices(in, matrix.row_offsets);
+    r1cs_csr_read_indices(in, matrix.columns);
+    r1cs_csr_read_indices(in, matrix.coefficient_indices);
+    in >> matrix.coefficients;
+
+    return in;
+}
+
+/**
+ * Appends the terms of `lc` as a new row of `matrix`. `coefficient_index`
+ * maps the Montgomery representation of every coefficient already in the
+ * table to its index.
+ */
+template<typename FieldT>
+void r1cs_csr_append_row(r1cs_csr_matrix<FieldT> &matrix,
+                         const linear_combination<FieldT> &lc,
+                         std::map<std::vector<mp_limb_t>, uint32_t> &coefficient_index)
+{
+    for (const linear_term<FieldT> &lt : lc.terms)
+    {
+        assert(lt.index <= std::numeric_limits<uint32_t>::max());
+
+        const std::vector<mp_limb_t> key(lt.coeff.mont_repr.data, lt.coeff.mont_repr.data + FieldT::num_limbs);
+        auto it = coefficient_index.find(key);
+        if (it == coefficient_index.end())
+        {
+            it = coefficient_index.emplace(key, matrix.coefficients.size()).first;
+            matrix.coefficients.emplace_back(lt.coeff);
+        }
+
+        matrix.columns.emplace_back(lt.index);
+        matrix.coefficient_indices.emplace_back(it->second);
+    }
+
+    matrix.row_offsets.emplace_back(matrix.columns.size());
+}
+
+template<typename FieldT>
+r1cs_csr_constraint_system<FieldT>::r1cs_csr_constraint_system(const r1cs_constraint_system<FieldT> &cs) :
+    primary_input_size(cs.primary_input_size),
+    auxiliary_input_size(cs.auxiliary_input_size)
+{
+    assert(cs.num_variables() <= std::numeric_limits<uint32_t>::max());
+
+    r1cs_csr_matrix<FieldT> *matrices[3] = { &A, &B, &C };
+    std::map<std::vector<mp_limb_t>, uint32_t> coefficient_index[3];
+    for (size_t m = 0; m < 3; ++m)
+    {
+        const FieldT one = FieldT::one();
+        coefficient_index[m].emplace(std::vector<mp_limb_t>(one.mont_repr.data, one.mont_repr.data + FieldT::num_limbs), 0);
+        matrices[m]->row_offsets.reserve(cs.num_constraints() + 1);
+    }
+
+    for (const r1cs_constraint<FieldT> &constraint : cs.constraints)
+    {
+        r1cs_csr_append_row(A, constraint.a, coefficient_index[0]);
+        r1cs_csr_append_row(B, constraint.b, coefficient_index[1]);
+        r1cs_csr_append_row(C, constraint.c, coefficient_index[2]);
+    }
+}
+
+template<typename FieldT>
+bool r1cs_csr_constraint_system<FieldT>::is_satisfied(const r1cs_primary_input<FieldT> &primary_input,
+                                                      const r1cs_auxiliary_input<FieldT> &auxiliary_input) const
+{
+    assert(primary_input.size() == num_inputs());
+    assert(primary_input.size() + auxiliary_input.size() == num_variables());
+
+    const r1cs_padded_assignment<FieldT> z(primary_input, auxiliary_input);
+
+    const size_t rows = num_constraints();
+    bool satisfied = true;
+
+#ifdef MULTICORE
+#pragma omp parallel for reduction(&&:satisfied)
+#endif
+    for (size_t i = 0; i < rows; ++i)
+    {
+        if (A.evaluate_row(i, z) * B.evaluate_row(i, z) != C.evaluate_row(i, z))
+        {
+            satisfied = false;
+        }
+    }
+
+    return satisfied;
+}
+
+template<typename FieldT>
+void r1cs_csr_constraint_system<FieldT>::validate() const
+{
+    if (num_variables() < primary_input_size || num_variables() >= std::numeric_limits<uint32_t>::max())
+    {
+        throw std::invalid_argument("r1cs_csr_constraint_system: too many variables");
+    }
+
+    A.validate(num_variables() + 1);
+    B.validate(num_variables() + 1);
+    C.validate(num_variables() + 1);
+
+    if (B.num_rows() != A.num_rows() || C.num_rows() != A.num_rows())
+    {
+        throw std::invalid_argument("r1cs_csr_constraint_system: A, B and C have different numbers of rows");
+    }
+}
+
+template<typename FieldT>
+void r1cs_csr_constraint_system<FieldT>::print_size() const
+{
+    libff::print_indent(); printf("* Constraint matrix non-zero terms (A, B, C): %zu, %zu, %zu\n",
+                                  A.num_nonzero(), B.num_nonzero(), C.num_nonzero());
+    libff::print_indent(); printf("* Distinct coefficients (A, B, C): %zu, %zu, %zu\n",
+                                  A.coefficients.size(), B.coefficients.size(), C.coefficients.size());
+    libff::print_indent(); printf("* Constraint matrices size in bytes: %zu\n", this->size_in_bytes());
+}
+
+template<typename FieldT>
+bool r1cs_csr_constraint_system<FieldT>::operator==(const r1cs_csr_constraint_system<FieldT> &other) const
+{
+    return (this->primary_input_size == other.primary_input_size &&
+            this->auxiliary_input_size == other.auxiliary_input_size &&
+            this->A == other.A &&
+            this->B == other.B &&
+            this->C == other.C);
+}
+
+template<typename FieldT>
+std::ostream& operator<<(std::ostream &out, const r1cs_csr_constraint_system<FieldT> &cs)
+{
+    out << cs.primary_input_size << "\n";
+    out << cs.auxiliary_input_size << "\n";
+    out << cs.A;
+    out << cs.B;
+    out << cs.C;
+
+    return out;
+}
+
+template<typename FieldT>
+std::istream& operator>>(std::istream &in, r1cs_csr_constraint_system<FieldT> &cs)
+{
+    in >> cs.primary_input_size;
+    libff::consume_newline(in);
+    in >> cs.auxiliary_input_size;
+    libff::consume_newline(in);
+    in >> cs.A;
+    in >> cs.B;
+    in >> cs.C;
+
+    return in;
+}
+
+template<typename FieldT>
+qap_witness<FieldT> r1cs_csr_to_qap_witness_map(const r1cs_csr_constraint_system<FieldT> &cs,
+                                                const r1cs_primary_input<FieldT> &primary_input,
+                                                const r1cs_auxiliary_input<FieldT> &auxiliary_input)
+{
+    const qap_evaluation_domain<FieldT> domain(cs.num_constraints() + cs.num_inputs() + 1, false);
+    return r1cs_csr_to_qap_witness_map(cs, primary_input, auxiliary_input, domain);
+}
+
+template<typename FieldT>
+qap_instance_evaluation<FieldT> r1cs_csr_to_qap_instance_map_with_evaluation(const r1cs_csr_constraint_system<FieldT> &cs,
+                                                                             const FieldT &t,
+                                                                             libff::bit_vector &At_density,
+                                                                             libff::bit_vector &Bt_density)
+{
+    libff::enter_block("Call to r1cs_csr_to_qap_instance_map_with_evaluation");
+
+#ifdef MULTICORE
+    const size_t chunks = omp_get_max_threads(); // to override, set OMP_NUM_THREADS env var or call omp_set_num_threads()
+#else
+    const size_t chunks = 1;
+#endif
+
+    const size_t num_constraints = cs.num_constraints();
+    const qap_evaluation_domain<FieldT> domain(num_constraints + cs.num_inputs() + 1, false);
+
+    const FieldT Zt = domain.domain->compute_vanishing_polynomial(t);
+
+    libff::enter_block("Compute evaluations of Lagrange polynomials at t");
+    const std::vector<FieldT> u = domain.domain->evaluate_all_lagrange_polynomials(t);
+    libff::leave_block("Compute evaluations of Lagrange polynomials at t");
+
+    std::vector<FieldT> At(cs.num_variables() + 1, FieldT::zero());
+    std::vector<FieldT> Bt(cs.num_variables() + 1, FieldT::zero());
+    std::vector<FieldT> Ct(cs.num_variables() + 1, FieldT::zero());
+
+    /* account for the additional constraints input_i * 0 = 0 */
+    for (size_t i = 0; i <= cs.num_inputs(); ++i)
+    {
+        At[i] = u[num_constraints + i];
+    }
+
+    libff::enter_block("Compute evaluations of A, B, C at t");
+    const size_t non_zero_At = cs.A.accumulate_columns(u, At, &At_density, chunks);
+    const size_t non_zero_Bt = cs.B.accumulate_columns(u, Bt, &Bt_density, chunks);
+    cs.C.accumulate_columns(u, Ct, nullptr, chunks);
+    libff::leave_block("Compute evaluations of A, B, C at t");
+
+    if (!libff::inhibit_profiling_info)
+    {
+        libff::print_indent(); printf("* Non-zero A_i(t), B_i(t): %zu, %zu\n", non_zero_At, non_zero_Bt);
+    }
+
+    libff::enter_block("Compute powers of t");
+    std::vector<FieldT> Ht(domain.m + 1);
+#ifdef MULTICORE
+#pragma omp parallel for num_threads(chunks)
+#endif
+    for (size_t p = 0; p < chunks; ++p)
+    {
+        const size_t begin = Ht.size() * p / chunks;
+        const size_t end = Ht.size() * (p + 1) / chunks;
+
+        FieldT ti = t ^ begin;
+        for (size_t i = begin; i < end; ++i)
+        {
+            Ht[i] = ti;
+            ti *= t;
+        }
+    }
+    libff::leave_block("Compute powers of t");
+
+    libff::leave_block("Call to r1cs_csr_to_qap_instance_map_with_evaluation");
+
+    return qap_instance_evaluation<FieldT>(domain.domain,
+                                           cs.num_variables(),
+                                           domain.m,
+                                           cs.num_inputs(),
+                                           t,
+                                           std::move(At),
+                                           std::move(Bt),
+                                           std::move(Ct),
+                                           std::move(Ht),
+                                           Zt);
+}
+
+template<typename FieldT>
+void r1cs_csr_to_qap_H_coefficients(const r1cs_csr_constraint_system<FieldT> &cs,
+                                    const r1cs_padded_assignment<FieldT> &z,
+                                    const qap_evaluation_domain<FieldT> &domain,
+                                    std::vector<FieldT> &H,
+                                    std::vector<FieldT> &scratch)
+{
+#ifdef MULTICORE
+    const size_t chunks = omp_get_max_threads(); // to override, set OMP_NUM_THREADS env var or call omp_set_num_threads()
+#else
+    const size_t chunks = 1;
+#endif
+
+    const size_t num_constraints = cs.num_constraints();
+    assert(domain.m >= num_constraints + cs.num_inputs() + 1);
+    assert(z.size() == cs.num_variables() + 1);
+
+    /* H ends with one more coefficient than the domain size, reserving it
+       now keeps the buffer from being reallocated below */
+    reserve_huge_pages(H, domain.m + 1);
+    reserve_huge_pages(scratch, domain.m);
+
+    libff::enter_block("Compute evaluation of polynomials A, B on set S");
+    std::vector<FieldT> &aA = H, &aB = scratch;
+    aA.assign(domain.m, FieldT::zero());
+    aB.assign(domain.m, FieldT::zero());
+
+    /* account for the additional constraints input_i * 0 = 0 */
+    for (size_t i = 0; i <= cs.num_inputs(); ++i)
+    {
+        aA[i+num_constraints] = z[i];
+    }
+    cs.A.multiply(z, aA.begin(), chunks);
+    cs.B.multiply(z, aB.begin(), chunks);
+    libff::leave_block("Compute evaluation of polynomials A, B on set S");
+
+    libff::enter_block("Compute coefficients of polynomial A");
+    domain.iFFT(aA);
+    libff::leave_block("Compute coefficients of polynomial A");
+
+    libff::enter_block("Compute coefficients of polynomial B");
+    domain.iFFT(aB);
+    libff::leave_block("Compute coefficients of polynomial B");
+
+    libff::enter_block("Compute evaluation of polynomial A on set T");
+    domain.cosetFFT(aA);
+    libff::leave_block("Compute evaluation of polynomial A on set T");
+
+    libff::enter_block("Compute evaluation of polynomial B on set T");
+    domain.cosetFFT(aB);
+    libff::leave_block("Compute evaluation of polynomial B on set T");
+
+    libff::enter_block("Compute evaluation of polynomial H on set T");
+    std::vector<FieldT> &H_tmp = aA; // can overwrite aA because it is not used later
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
+    for (size_t i = 0; i < domain.m; ++i)
+    {
+        H_tmp[i] = aA[i]*aB[i];
+    }
+
+    libff::enter_block("Compute evaluation of polynomial C on set S");
+    std::vector<FieldT> &aC = scratch; // aB is not used later either
+    aC.assign(domain.m, FieldT::zero());
+    cs.C.multiply(z, aC.begin(), chunks);
+    libff::leave_block("Compute evaluation of polynomial C on set S");
+
+    libff::enter_block("Compute coefficients of polynomial C");
+    domain.iFFT(aC);
+    libff::leave_block("Compute coefficients of polynomial C");
+
+    libff::enter_block("Compute evaluation of polynomial C on set T");
+    domain.cosetFFT(aC);
+    libff::leave_block("Compute evaluation of polynomial C on set T");
+
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
+    for (size_t i = 0; i < domain.m; ++i)
+    {
+        H_tmp[i] = (H_tmp[i]-aC[i]);
+    }
+
+    libff::enter_block("Divide by Z on set T");
+    domain.divide_by_Z_on_coset(H_tmp);
+    libff::leave_block("Divide by Z on set T");
+
+    libff::leave_block("Compute evaluation of polynomial H on set T");
+
+    libff::enter_block("Compute coefficients of polynomial H");
+    domain.icosetFFT(H_tmp);
+    libff::leave_block("Compute coefficients of polynomial H");
+
+    /* Without the zero-knowledge patch the coefficients are those of H_tmp */
+    H_tmp.emplace_back(FieldT::zero());
+}
+
+template<typename FieldT>
+qap_witness<FieldT> r1cs_csr_to_qap_witness_map(const r1cs_csr_constraint_system<FieldT> &cs,
+                                                const r1cs_primary_input<FieldT> &primary_input,
+                                                const r1cs_auxiliary_input<FieldT> &auxiliary_input,
+                                                const qap_evaluation_domain<FieldT> &domain)
+{
+    libff::enter_block("Call to r1cs_csr_to_qap_witness_map");
+
+    /* sanity check */
+    assert(cs.is_satisfied(primary_input, auxiliary_input));
+
+    /* z = (1, x_1, ..., x_n), so that matrix columns index it directly */
+    const r1cs_padded_assignment<FieldT> z(primary_input, auxiliary_input);
+
+    std::vector<FieldT> coefficients_for_H, scratch;
+    r1cs_csr_to_qap_H_coefficients(cs, z, domain, coefficients_for_H, scratch);
+    std::vector<FieldT>().swap(scratch); // destroy scratch
+
+    /* The witness owns its copy of the assignment */
+    std::vector<FieldT> full_variable_assignment(primary_input);
+    full_variable_assignment.insert(full_variable_assignment.end(), auxiliary_input.begin(), auxiliary_input.end());
+
+    libff::leave_block("Call to r1cs_csr_to_qap_witness_map");
+
+    return qap_witness<FieldT>(cs.num_variables(),
+                               domain.m,
+                               cs.num_inputs(),
+                               FieldT::zero(),
+                               FieldT::zero(),
+                               FieldT::zero(),
+                               full_variable_assignment,
+                               std::move(coefficients_for_H));
+}
+
+} // libsnark
+
+#endif // R1CS_CSR_CONSTRAINT_SYSTEM_TCC_
@@ -46,14 +46,21 @@ References:
 #ifndef R1CS_GG_PPZKSNARK_HPP_
 #define R1CS_GG_PPZKSNARK_HPP_
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 #include <libff/algebra/curves/public_params.hpp>
+#include <libff/algebra/scalar_multiplication/multiexp.hpp>
 
 #include <libsnark/common/data_structures/accumulation_vector.hpp>
 #include <libsnark/knowledge_commitment/knowledge_commitment.hpp>
 #include <libsnark/relations/constraint_satisfaction_problems/r1cs/r1cs.hpp>
+#include "r1cs_gg_ppzksnark_zok/huge_pages.hpp"
+#include "r1cs_gg_ppzksnark_zok/qap_evaluation_domain.hpp"
 #include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_params.hpp"
+#include "r1cs_gg_ppzksnark_zok/scalar_multiplication/pippenger_fixed_base.hpp"
 
 namespace libsnark {
 
@@ -80,12 +87,16 @@ public:
     libff::G1<ppT> delta_g1;
     libff::G2<ppT> delta_g2;
 
+    /* A_density[i] is set when A_i(t), and so A_query[i], is not zero; the
+       prover skips the other bases of A_query */
+    libff::bit_vector A_density;
     libff::G1_vector<ppT> A_query; // this could be a sparse vector if we had multiexp for those
     knowledge_commitment_vector<libff::G2<ppT>, libff::G1<ppT> > B_query;
     libff::G1_vector<ppT> H_query;
     libff::G1_vector<ppT> L_query;
 
-    r1cs_gg_ppzksnark_zok_constraint_system<ppT> constraint_system;
+    /* The constraint system, kept as the sparse matrices needed to compute H */
+    r1cs_gg_ppzksnark_zok_constraint_matrices<ppT> constraint_matrices;
 
     r1cs_gg_ppzksnark_zok_proving_key() {};
     r1cs_gg_ppzksnark_zok_proving_key<ppT>& operator=(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &other) = default;
@@ -96,21 +107,23 @@ public:
                                   libff::G2<ppT> &&beta_g2,
                                   libff::G1<ppT> &&delta_g1,
                                   libff::G2<ppT> &&delta_g2,
+                                  libff::bit_vector &&A_density,
                                   libff::G1_vector<ppT> &&A_query,
                                   knowledge_commitment_vector<libff::G2<ppT>, libff::G1<ppT> > &&B_query,
                                   libff::G1_vector<ppT> &&H_query,
                                   libff::G1_vector<ppT> &&L_query,
-                                  r1cs_gg_ppzksnark_zok_constraint_system<ppT> &&constraint_system) :
+                                  r1cs_gg_ppzksnark_zok_constraint_matrices<ppT> &&constraint_matrices) :
         alpha_g1(std::move(alpha_g1)),
         beta_g1(std::move(beta_g1)),
         beta_g2(std::move(beta_g2)),
         delta_g1(std::move(delta_g1)),
         delta_g2(std::move(delta_g2)),
+        A_density(std::move(A_density)),
         A_query(std::move(A_query)),
         B_query(std::move(B_query)),
         H_query(std::move(H_query)),
         L_query(std::move(L_query)),
-        constraint_system(std::move(constraint_system))
+        constraint_matrices(std::move(constraint_matrices))
     {};
 
     size_t G1_size() const
@@ -147,6 +160,7 @@ public:
         libff::print_indent(); printf("* G2 elements in PK: %zu\n", this->G2_size());
         libff::print_indent(); printf("* Non-zero G2 elements in PK: %zu\n", this->G2_sparse_size());
         libff::print_indent(); printf("* PK size in bits: %zu\n", this->size_in_bits());
+        constraint_matrices.print_size();
     }
 
     bool operator==(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &other) const;
@@ -155,6 +169,140 @@ public:
 };
 
 
+/****************************** Prover context *******************************/
+
+/**
+ * State derived from a proving key that every proof made with that key
+ * needs: the evaluation domain of the QAP, with its twiddle factors and
+ * coset powers, see qap_evaluation_domain.hpp , and window tables of the
+ * points the blinding factors r and s multiply, so that those products
+ * are fixed-base exponentiations.
+ *
+ * A long-running prover creates the context once and passes it to every
+ * proof. The prover does not modify it, so concurrent proofs may share it.
+ */
+template<typename ppT>
+class r1cs_gg_ppzksnark_zok_prover_context {
+public:
+    qap_evaluation_domain<libff::Fr<ppT> > domain;
+
+    size_t blinding_window_size;
+    libff::window_table<libff::G1<ppT> > alpha_g1_table;
+    libff::window_table<libff::G1<ppT> > beta_g1_table;
+    libff::window_table<libff::G1<ppT> > delta_g1_table;
+    libff::window_table<libff::G2<ppT> > delta_g2_table;
+
+    explicit r1cs_gg_ppzksnark_zok_prover_context(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk);
+
+    size_t size_in_bytes() const
+    {
+        size_t window_entries = 0;
+        for (const auto &window : delta_g2_table)
+        {
+            window_entries += window.size();
+        }
+        return domain.tables_size_in_bytes() +
+            window_entries * (3 * sizeof(libff::G1<ppT>) + sizeof(libff::G2<ppT>));
+    }
+
+    void print_size() const
+    {
+        libff::print_indent(); printf("* Prover context domain size: %zu\n", domain.m);
+        libff::print_indent(); printf("* Prover context blinding window: %zu\n", blinding_window_size);
+        libff::print_indent(); printf("* Prover context size in bytes: %zu\n", this->size_in_bytes());
+    }
+};
+
+
+/***************************** Prover workspace ******************************/
+
+/**
+ * The buffers a proof fills with scalars: the two vectors of the size of
+ * the evaluation domain in which H is computed. The assignment itself is
+ * read in place, see r1cs_padded_assignment.hpp .
+ *
+ * They are several hundred MB for large circuits. A workspace keeps them
+ * from one proof to the next, so a long-running prover allocates them, and
+ * faults their pages in, once rather than on every proof; they are
+ * reserved on transparent huge pages where available, see huge_pages.hpp .
+ *
+ * The prover writes to the workspace, so unlike the prover context each
+ * thread making proofs needs its own.
+ */
+template<typename ppT>
+class r1cs_gg_ppzksnark_zok_prover_workspace {
+public:
+    libff::Fr_vector<ppT> H;
+    libff::Fr_vector<ppT> H_scratch;
+
+    /* The buffers are then allocated by the first proof */
+    r1cs_gg_ppzksnark_zok_prover_workspace() {};
+
+    /* Reserves the buffers for proofs made with `context` */
+    explicit r1cs_gg_ppzksnark_zok_prover_workspace(const r1cs_gg_ppzksnark_zok_prover_context<ppT> &context)
+    {
+        reserve_huge_pages(H, context.domain.m + 1);
+        reserve_huge_pages(H_scratch, context.domain.m);
+    };
+
+    size_t size_in_bytes() const
+    {
+        return (H.capacity() + H_scratch.capacity()) * sizeof(libff::Fr<ppT>);
+    }
+
+    void print_size() const
+    {
+        libff::print_indent(); printf("* Prover workspace size in bytes: %zu\n", this->size_in_bytes());
+    }
+};
+
+
+/*************************** Expanded proving key ****************************/
+
+/**
+ * A proving key together with its prover context and precomputed multiples
+ * of the bases of its A, H and L queries, see
+ * scalar_multiplication/pippenger_fixed_base.hpp .
+ *
+ * Building the tables is done once and costs about one scalar multiplication
+ * per base; every proof made with the expanded key then evaluates those
+ * queries with the fixed-base method. The tables only live in memory, they
+ * are not part of the serialized key. A query whose table is empty is
+ * evaluated from the key, as with a plain proving key.
+ */
+template<typename ppT>
+class r1cs_gg_ppzksnark_zok_expanded_proving_key {
+public:
+    r1cs_gg_ppzksnark_zok_proving_key<ppT> pk;
+    r1cs_gg_ppzksnark_zok_prover_context<ppT> context;
+
+    pippenger_fixed_base_table<libff::G1<ppT> > A_table;
+    pippenger_fixed_base_table<libff::G1<ppT> > H_table;
+    pippenger_fixed_base_table<libff::G1<ppT> > L_table;
+
+    /**
+     * The tables take at most `max_table_bytes`; they are empty when it does
+     * not leave room for one multiple of every base.
+     */
+    r1cs_gg_ppzksnark_zok_expanded_proving_key(r1cs_gg_ppzksnark_zok_proving_key<ppT> &&pk,
+                                               const size_t max_table_bytes);
+
+    size_t table_size_in_bytes() const
+    {
+        return A_table.size_in_bytes() + H_table.size_in_bytes() + L_table.size_in_bytes();
+    }
+
+    void print_size() const
+    {
+        libff::print_indent(); printf("* Expanded PK table size in bytes: %zu\n", this->table_size_in_bytes());
+        libff::print_indent(); printf("* Stored multiples per base (A, H, L): %zu, %zu, %zu\n",
+                                      A_table.multiples.size() / std::max<size_t>(A_table.num_bases, 1),
+                                      H_table.multiples.size() / std::max<size_t>(H_table.num_bases, 1),
+                                      L_table.multiples.size() / std::max<size_t>(L_table.num_bases, 1));
+    }
+};
+
+
 /******************************* Verification key ****************************/
 
 template<typename ppT>
@@ -244,13 +392,14 @@ std::istream& operator>>(std::istream &in, r1cs_gg_ppzksnark_zok_processed_verif
  *
  * Compared to a (non-processed) verification key, a processed verification key
  * contains a small constant amount of additional pre-computed information that
- * enables a faster verification time.
+ * enables a faster verification time: e(alpha, beta), which depends on the key
+ * only, is computed once, so a proof costs one Miller loop for e(A, B), one
+ * double Miller loop for the input and C terms, and one final exponentiation.
  */
 template<typename ppT>
 class r1cs_gg_ppzksnark_zok_processed_verification_key {
 public:
-    libff::G1<ppT> vk_alpha_g1;
-    libff::G2<ppT> vk_beta_g2;
+    libff::GT<ppT> vk_alpha_g1_beta_g2;
     libff::G2_precomp<ppT> vk_gamma_g2_precomp;
     libff::G2_precomp<ppT> vk_delta_g2_precomp;
 
@@ -360,6 +509,76 @@ public:
 };
 
 
+/******************************* Prover config *******************************/
+
+/**
+ * Multi-exponentiation methods the prover can use to evaluate a query.
+ */
+enum r1cs_gg_ppzksnark_zok_multi_exp_method {
+    /** The BDLO12 bucket method from libff, as used by upstream libsnark */
+    r1cs_gg_ppzksnark_zok_multi_exp_BDLO12,
+    /** Signed-digit bucket method, see scalar_multiplication/pippenger.hpp */
+    r1cs_gg_ppzksnark_zok_multi_exp_pippenger
+};
+
+/**
+ * Selects the multi-exponentiation method used for each of the prover's
+ * A, B, H and L queries, and how they are scheduled.
+ *
+ * With `overlap_tasks` set (and MULTICORE), the computation of H and the
+ * evaluations of the A, B (G2 and G1 halves separately) and L queries run
+ * concurrently, sharing the threads in proportion to their estimated cost.
+ * Otherwise they run one after the other, each using every thread.
+ */
+class r1cs_gg_ppzksnark_zok_prover_config {
+public:
+    r1cs_gg_ppzksnark_zok_multi_exp_method A_query_method;
+    r1cs_gg_ppzksnark_zok_multi_exp_method B_query_method;
+    r1cs_gg_ppzksnark_zok_multi_exp_method H_query_method;
+    r1cs_gg_ppzksnark_zok_multi_exp_method L_query_method;
+
+    bool overlap_tasks;
+
+    r1cs_gg_ppzksnark_zok_prover_config(const r1cs_gg_ppzksnark_zok_multi_exp_method method = r1cs_gg_ppzksnark_zok_multi_exp_BDLO12) :
+        A_query_method(method),
+        B_query_method(method),
+        H_query_method(method),
+        L_query_method(method),
+        overlap_tasks(true)
+    {};
+};
+
+
+/***************************** Blinding factors ******************************/
+
+/**
+ * The blinding factors r and s of a proof.
+ *
+ * The prover draws fresh random ones for every proof. Passing fixed ones
+ * instead makes it deterministic, so that proofs made with different
+ * configurations, keys or provers for the same witness can be compared bit
+ * for bit. A proof only hides the witness when its factors are random,
+ * secret and used once.
+ */
+template<typename ppT>
+class r1cs_gg_ppzksnark_zok_blinding_factors {
+public:
+    libff::Fr<ppT> r;
+    libff::Fr<ppT> s;
+
+    r1cs_gg_ppzksnark_zok_blinding_factors(const libff::Fr<ppT> &r, const libff::Fr<ppT> &s) :
+        r(r), s(s)
+    {};
+
+    /* Fresh random factors, as the prover draws by default */
+    static r1cs_gg_ppzksnark_zok_blinding_factors<ppT> random();
+
+    /* Factors expanded from `seed` by a Mersenne twister, which is not a
+       cryptographic generator; for benchmarks and tests only */
+    static r1cs_gg_ppzksnark_zok_blinding_factors<ppT> from_seed(const uint64_t seed);
+};
+
+
 /***************************** Main algorithms *******************************/
 
 /**
@@ -370,6 +589,14 @@ public:
 template<typename ppT>
 r1cs_gg_ppzksnark_zok_keypair<ppT> r1cs_gg_ppzksnark_zok_generator(const r1cs_gg_ppzksnark_zok_constraint_system<ppT> &cs);
 
+/**
+ * As above, consuming `cs` instead of copying it. Only the constraints and
+ * the input sizes are read: no assignment is needed, and the annotations
+ * of the constraint system are released with it.
+ */
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_keypair<ppT> r1cs_gg_ppzksnark_zok_generator(r1cs_gg_ppzksnark_zok_constraint_system<ppT> &&cs);
+
 /**
  * A prover algorithm for the R1CS GG-ppzkSNARK.
  *
@@ -383,6 +610,108 @@ r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(const r1cs_gg_ppzk
                                                       const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
                                                       const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input);
 
+/**
+ * As above, evaluating each query with the method selected in `config`.
+ */
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk,
+                                                      const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                      const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                                      const r1cs_gg_ppzksnark_zok_prover_config &config);
+
+/**
+ * As above, reusing the evaluation domain of a prover context created for
+ * `pk` instead of preparing it for this proof only.
+ */
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk,
+                                                      const r1cs_gg_ppzksnark_zok_prover_context<ppT> &context,
+                                                      const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                      const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                                      const r1cs_gg_ppzksnark_zok_prover_config &config = r1cs_gg_ppzksnark_zok_prover_config());
+
+/**
+ * As above, computing the scalars of the proof in the buffers of
+ * `workspace` instead of allocating them for this proof only.
+ */
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk,
+                                                      const r1cs_gg_ppzksnark_zok_prover_context<ppT> &context,
+                                                      r1cs_gg_ppzksnark_zok_prover_workspace<ppT> &workspace,
+                                                      const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                      const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                                      const r1cs_gg_ppzksnark_zok_prover_config &config = r1cs_gg_ppzksnark_zok_prover_config());
+
+/**
+ * As above, evaluating the A, H and L queries with the precomputed tables of
+ * an expanded proving key. `config` only selects the method for the B query.
+ */
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(const r1cs_gg_ppzksnark_zok_expanded_proving_key<ppT> &epk,
+                                                      const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                      const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                                      const r1cs_gg_ppzksnark_zok_prover_config &config = r1cs_gg_ppzksnark_zok_prover_config());
+
+/**
+ * As above, with the buffers of `workspace`.
+ */
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(const r1cs_gg_ppzksnark_zok_expanded_proving_key<ppT> &epk,
+                                                      r1cs_gg_ppzksnark_zok_prover_workspace<ppT> &workspace,
+                                                      const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                      const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                                      const r1cs_gg_ppzksnark_zok_prover_config &config = r1cs_gg_ppzksnark_zok_prover_config());
+
+/**
+ * As the prover overloads above, with the blinding factors of `blinding`
+ * instead of random ones.
+ */
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk,
+                                                      const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                      const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                                      const r1cs_gg_ppzksnark_zok_blinding_factors<ppT> &blinding,
+                                                      const r1cs_gg_ppzksnark_zok_prover_config &config = r1cs_gg_ppzksnark_zok_prover_config());
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk,
+                                                      const r1cs_gg_ppzksnark_zok_prover_context<ppT> &context,
+                                                      r1cs_gg_ppzksnark_zok_prover_workspace<ppT> &workspace,
+                                                      const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                      const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                                      const r1cs_gg_ppzksnark_zok_blinding_factors<ppT> &blinding,
+                                                      const r1cs_gg_ppzksnark_zok_prover_config &config = r1cs_gg_ppzksnark_zok_prover_config());
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(const r1cs_gg_ppzksnark_zok_expanded_proving_key<ppT> &epk,
+                                                      r1cs_gg_ppzksnark_zok_prover_workspace<ppT> &workspace,
+                                                      const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                      const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                                      const r1cs_gg_ppzksnark_zok_blinding_factors<ppT> &blinding,
+                                                      const r1cs_gg_ppzksnark_zok_prover_config &config = r1cs_gg_ppzksnark_zok_prover_config());
+
+/**
+ * A batch prover algorithm for the R1CS GG-ppzkSNARK.
+ *
+ * Produces one proof for every (primary_inputs[i], auxiliary_inputs[i]) pair,
+ * exactly as r1cs_gg_ppzksnark_zok_prover would. The A, B, H and L queries are
+ * evaluated for all witnesses together, so each query vector is streamed
+ * through memory once per batch instead of once per proof.
+ */
+template<typename ppT>
+std::vector<r1cs_gg_ppzksnark_zok_proof<ppT> > r1cs_gg_ppzksnark_zok_batch_prover(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk,
+                                                                                  const std::vector<r1cs_gg_ppzksnark_zok_primary_input<ppT> > &primary_inputs,
+                                                                                  const std::vector<r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> > &auxiliary_inputs);
+
+/**
+ * As above, with blinding[i] for the i-th proof.
+ */
+template<typename ppT>
+std::vector<r1cs_gg_ppzksnark_zok_proof<ppT> > r1cs_gg_ppzksnark_zok_batch_prover(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk,
+                                                                                  const std::vector<r1cs_gg_ppzksnark_zok_primary_input<ppT> > &primary_inputs,
+                                                                                  const std::vector<r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> > &auxiliary_inputs,
+                                                                                  const std::vector<r1cs_gg_ppzksnark_zok_blinding_factors<ppT> > &blinding);
+
 /*
   Below are four variants of verifier algorithm for the R1CS GG-ppzkSNARK.
 
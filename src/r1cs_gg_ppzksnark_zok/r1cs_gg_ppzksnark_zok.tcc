@@ -15,10 +15,14 @@ See r1cs_gg_ppzksnark_zok.hpp .
 #define R1CS_GG_PPZKSNARK_TCC_
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <functional>
+#include <memory>
 #include <iostream>
+#include <random>
 #include <sstream>
+#include <string>
 
 #include <libff/algebra/scalar_multiplication/multiexp.hpp>
 #include <libff/common/profiling.hpp>
@@ -31,8 +35,68 @@ See r1cs_gg_ppzksnark_zok.hpp .
 #include <libsnark/knowledge_commitment/kc_multiexp.hpp>
 #include <libsnark/reductions/r1cs_to_qap/r1cs_to_qap.hpp>
 
+#include "r1cs_gg_ppzksnark_zok/scalar_multiplication/multiexp_batch.hpp"
+#include "r1cs_gg_ppzksnark_zok/scalar_multiplication/multiexp_density.hpp"
+#include "r1cs_gg_ppzksnark_zok/scalar_multiplication/glv.hpp"
+#include "r1cs_gg_ppzksnark_zok/scalar_multiplication/pippenger.hpp"
+
 namespace libsnark {
 
+/**
+ * Packs `density` into 64-bit words, bit b of word w being density[64*w + b].
+ */
+inline std::vector<uint64_t> r1cs_gg_ppzksnark_zok_pack_density(const libff::bit_vector &density)
+{
+    std::vector<uint64_t> words((density.size() + 63) / 64, 0);
+    for (size_t i = 0; i < density.size(); ++i)
+    {
+        if (density[i])
+        {
+            words[i / 64] |= uint64_t(1) << (i % 64);
+        }
+    }
+
+    return words;
+}
+
+inline libff::bit_vector r1cs_gg_ppzksnark_zok_unpack_density(const uint64_t *words, const size_t size)
+{
+    libff::bit_vector density(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        density[i] = (words[i / 64] >> (i % 64)) & 1;
+    }
+
+    return density;
+}
+
+/**
+ * A density is written as its size, then its packed words as the index
+ * arrays of the constraint matrices are.
+ */
+inline void r1cs_gg_ppzksnark_zok_write_density(std::ostream &out, const libff::bit_vector &density)
+{
+    out << density.size() << "\n";
+    r1cs_csr_write_indices(out, r1cs_gg_ppzksnark_zok_pack_density(density));
+}
+
+inline void r1cs_gg_ppzksnark_zok_read_density(std::istream &in, libff::bit_vector &density)
+{
+    size_t size;
+    in >> size;
+    libff::consume_newline(in);
+
+    std::vector<uint64_t> words;
+    r1cs_csr_read_indices(in, words);
+    if (!in || words.size() != (size + 63) / 64)
+    {
+        in.setstate(std::ios::failbit);
+        return;
+    }
+
+    density = r1cs_gg_ppzksnark_zok_unpack_density(words.data(), size);
+}
+
 template<typename ppT>
 bool r1cs_gg_ppzksnark_zok_proving_key<ppT>::operator==(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &other) const
 {
@@ -41,11 +105,12 @@ bool r1cs_gg_ppzksnark_zok_proving_key<ppT>::operator==(const r1cs_gg_ppzksnark_
             this->beta_g2 == other.beta_g2 &&
             this->delta_g1 == other.delta_g1 &&
             this->delta_g2 == other.delta_g2 &&
+            this->A_density == other.A_density &&
             this->A_query == other.A_query &&
             this->B_query == other.B_query &&
             this->H_query == other.H_query &&
             this->L_query == other.L_query &&
-            this->constraint_system == other.constraint_system);
+            this->constraint_matrices == other.constraint_matrices);
 }
 
 template<typename ppT>
@@ -56,11 +121,12 @@ std::ostream& operator<<(std::ostream &out, const r1cs_gg_ppzksnark_zok_proving_
     out << pk.beta_g2 << OUTPUT_NEWLINE;
     out << pk.delta_g1 << OUTPUT_NEWLINE;
     out << pk.delta_g2 << OUTPUT_NEWLINE;
+    r1cs_gg_ppzksnark_zok_write_density(out, pk.A_density);
     out << pk.A_query;
     out << pk.B_query;
     out << pk.H_query;
     out << pk.L_query;
-    out << pk.constraint_system;
+    out << pk.constraint_matrices;
 
     return out;
 }
@@ -78,11 +144,12 @@ std::istream& operator>>(std::istream &in, r1cs_gg_ppzksnark_zok_proving_key<ppT
     libff::consume_OUTPUT_NEWLINE(in);
     in >> pk.delta_g2;
     libff::consume_OUTPUT_NEWLINE(in);
+    r1cs_gg_ppzksnark_zok_read_density(in, pk.A_density);
     in >> pk.A_query;
     in >> pk.B_query;
     in >> pk.H_query;
     in >> pk.L_query;
-    in >> pk.constraint_system;
+    in >> pk.constraint_matrices;
 
     return in;
 }
@@ -129,8 +196,7 @@ std::istream& operator>>(std::istream &in, r1cs_gg_ppzksnark_zok_verification_ke
 template<typename ppT>
 bool r1cs_gg_ppzksnark_zok_processed_verification_key<ppT>::operator==(const r1cs_gg_ppzksnark_zok_processed_verification_key<ppT> &other) const
 {
-    return (this->vk_alpha_g1 == other.vk_alpha_g1 &&
-            this->vk_beta_g2 == other.vk_beta_g2 &&
+    return (this->vk_alpha_g1_beta_g2 == other.vk_alpha_g1_beta_g2 &&
             this->vk_gamma_g2_precomp == other.vk_gamma_g2_precomp &&
             this->vk_delta_g2_precomp == other.vk_delta_g2_precomp &&
             this->gamma_ABC_g1 == other.gamma_ABC_g1);
@@ -139,8 +205,7 @@ bool r1cs_gg_ppzksnark_zok_processed_verification_key<ppT>::operator==(const r1c
 template<typename ppT>
 std::ostream& operator<<(std::ostream &out, const r1cs_gg_ppzksnark_zok_processed_verification_key<ppT> &pvk)
 {
-    out << pvk.vk_alpha_g1 << OUTPUT_NEWLINE;
-    out << pvk.vk_beta_g2 << OUTPUT_NEWLINE;
+    out << pvk.vk_alpha_g1_beta_g2 << OUTPUT_NEWLINE;
     out << pvk.vk_gamma_g2_precomp << OUTPUT_NEWLINE;
     out << pvk.vk_delta_g2_precomp << OUTPUT_NEWLINE;
     out << pvk.gamma_ABC_g1 << OUTPUT_NEWLINE;
@@ -151,9 +216,7 @@ std::ostream& operator<<(std::ostream &out, const r1cs_gg_ppzksnark_zok_processe
 template<typename ppT>
 std::istream& operator>>(std::istream &in, r1cs_gg_ppzksnark_zok_processed_verification_key<ppT> &pvk)
 {
-    in >> pvk.vk_alpha_g1;
-    libff::consume_OUTPUT_NEWLINE(in);
-    in >> pvk.vk_beta_g2;
+    in >> pvk.vk_alpha_g1_beta_g2;
     libff::consume_OUTPUT_NEWLINE(in);
     in >> pvk.vk_gamma_g2_precomp;
     libff::consume_OUTPUT_NEWLINE(in);
@@ -217,13 +280,255 @@ r1cs_gg_ppzksnark_zok_verification_key<ppT> r1cs_gg_ppzksnark_zok_verification_k
     return result;
 }
 
+/**
+ * Rough cost, in group additions, of a multi-exponentiation with `num_ones`
+ * scalars equal to 1 and `num_dense` other scalars of `num_bits` bits.
+ */
+inline double r1cs_gg_ppzksnark_zok_multi_exp_cost(const size_t num_ones, const size_t num_dense, const size_t num_bits)
+{
+    return num_ones + (double)num_dense * num_bits / std::max<size_t>(libff::log2(num_dense), 1);
+}
+
+/**
+ * Rough cost, in group additions, of the FFTs computing H over a domain of
+ * about `degree` points: seven transforms of (degree/2) * log2(degree)
+ * field multiplications, each about a tenth of a group addition.
+ */
+inline double r1cs_gg_ppzksnark_zok_fft_cost(const size_t degree)
+{
+    return 7 * (double)degree / 2 * libff::log2(degree) / 10;
+}
+
+/**
+ * Run `tasks`, each given the number of threads it may use.
+ *
+ * With `max_concurrent` > 1 (and MULTICORE), up to that many tasks run at
+ * the same time and the `num_threads` threads are shared between them in
+ * proportion to `costs`; the time of each task is reported once they have
+ * all finished. Otherwise the tasks run one after the other with all the
+ * threads, each in its own profiling block.
+ */
+inline void r1cs_gg_ppzksnark_zok_run_tasks(const std::vector<std::string> &names,
+                                            const std::vector<double> &costs,
+                                            const std::vector<std::function<void(const size_t)> > &tasks,
+                                            const size_t max_concurrent,
+                                            const size_t num_threads)
+{
+    const size_t num_tasks = tasks.size();
+
+#ifdef MULTICORE
+    if (max_concurrent > 1 && num_threads > 1)
+    {
+        double total_cost = 0;
+        for (size_t i = 0; i < num_tasks; ++i)
+        {
+            total_cost += costs[i];
+        }
+
+        /* Every task gets one thread, the others are handed out in
+           proportion to the costs, with the rounding left-overs going to
+           the most expensive task */
+        std::vector<size_t> task_threads(num_tasks, 1);
+        const size_t spare_threads = (num_threads > num_tasks ? num_threads - num_tasks : 0);
+        size_t assigned_threads = 0;
+        size_t most_expensive = 0;
+        for (size_t i = 0; i < num_tasks; ++i)
+        {
+            if (total_cost > 0)
+            {
+                task_threads[i] += (size_t)(spare_threads * costs[i] / total_cost);
+            }
+            assigned_threads += task_threads[i] - 1;
+            if (costs[i] > costs[most_expensive])
+            {
+                most_expensive = i;
+            }
+        }
+        task_threads[most_expensive] += spare_threads - assigned_threads;
+
+        std::vector<long long> task_nsec(num_tasks);
+
+        /* Each task runs its own parallel regions, sized by its share */
+        const int max_active_levels = omp_get_max_active_levels();
+        omp_set_max_active_levels(std::max(max_active_levels, 2));
+
+#pragma omp parallel for schedule(dynamic, 1) num_threads(std::min(std::min(max_concurrent, num_tasks), num_threads))
+        for (size_t i = 0; i < num_tasks; ++i)
+        {
+            omp_set_num_threads(task_threads[i]);
+
+            const long long start = libff::get_nsec_time();
+            tasks[i](task_threads[i]);
+            task_nsec[i] = libff::get_nsec_time() - start;
+        }
+
+        omp_set_max_active_levels(max_active_levels);
+
+        if (!libff::inhibit_profiling_info)
+        {
+            for (size_t i = 0; i < num_tasks; ++i)
+            {
+                libff::print_indent(); printf("* %s: %zu threads, %.4fs\n", names[i].c_str(), task_threads[i], task_nsec[i] * 1e-9);
+            }
+        }
+
+        return;
+    }
+#else
+    libff::UNUSED(costs, max_concurrent);
+#endif
+
+    for (size_t i = 0; i < num_tasks; ++i)
+    {
+        libff::enter_block(names[i], false);
+        tasks[i](num_threads);
+        libff::leave_block(names[i], false);
+    }
+}
+
+/**
+ * Count of the elements computed by a task of the generator, printed at
+ * every tenth of `total` unless profiling info is inhibited. Safe to update
+ * from concurrent tasks.
+ */
+class r1cs_gg_ppzksnark_zok_progress {
+public:
+    r1cs_gg_ppzksnark_zok_progress(const std::string &name, const size_t total) :
+        name(name), total(total), done(0)
+    {};
+
+    void add(const size_t count)
+    {
+        const size_t before = done.fetch_add(count);
+        const size_t after = before + count;
+        if (total == 0 || 10 * before / total == 10 * after / total || libff::inhibit_profiling_info)
+        {
+            return;
+        }
+
+#ifdef MULTICORE
+#pragma omp critical(r1cs_gg_ppzksnark_zok_progress)
+#endif
+        {
+            libff::print_indent(); printf("* %s: %zu/%zu (%zu%%)\n", name.c_str(), after, total, 100 * after / total);
+            fflush(stdout);
+        }
+    }
+
+private:
+    const std::string name;
+    const size_t total;
+    std::atomic<size_t> done;
+};
+
+/**
+ * libff::get_window_table, with the rows of the table filled in parallel.
+ */
+template<typename T>
+libff::window_table<T> r1cs_gg_ppzksnark_zok_window_table(const size_t scalar_size,
+                                                          const size_t window,
+                                                          const T &g,
+                                                          const size_t chunks)
+{
+    const size_t in_window = 1ul << window;
+    const size_t outerc = (scalar_size + window - 1) / window;
+    const size_t last_in_window = 1ul << (scalar_size - (outerc - 1) * window);
+
+    /* Row `outer` holds the multiples of 2^(outer*window) * g */
+    std::vector<T> gouter(outerc);
+    gouter[0] = g;
+    for (size_t outer = 1; outer < outerc; ++outer)
+    {
+        gouter[outer] = gouter[outer - 1];
+        for (size_t i = 0; i < window; ++i)
+        {
+            gouter[outer] = gouter[outer].dbl();
+        }
+    }
+
+    libff::window_table<T> powers_of_g(outerc);
+
+#ifdef MULTICORE
+#pragma omp parallel for schedule(dynamic) num_threads(std::max<size_t>(chunks, 1))
+#else
+    libff::UNUSED(chunks);
+#endif
+    for (size_t outer = 0; outer < outerc; ++outer)
+    {
+        const size_t cur_in_window = (outer == outerc - 1) ? last_in_window : in_window;
+        powers_of_g[outer].assign(in_window, T::zero());
+
+        T ginner = T::zero();
+        for (size_t inner = 0; inner < cur_in_window; ++inner)
+        {
+            powers_of_g[outer][inner] = ginner;
+            ginner = ginner + gouter[outer];
+        }
+    }
+
+    return powers_of_g;
+}
+
+/**
+ * Writes windowed_exp(coeff * scalars[i]) into result(i) for every i below
+ * num_scalars, as libff::batch_exp_with_coeff does, in blocks shared by
+ * `chunks` threads. With USE_MIXED_ADDITION the results are converted to
+ * special form, one batch inversion per block.
+ */
+template<typename T, typename FieldT, typename OutputAccessor>
+void r1cs_gg_ppzksnark_zok_batch_exp(const size_t scalar_size,
+                                     const size_t window,
+                                     const libff::window_table<T> &table,
+                                     const FieldT &coeff,
+                                     const typename std::vector<FieldT>::const_iterator scalars,
+                                     const size_t num_scalars,
+                                     const OutputAccessor &result,
+                                     r1cs_gg_ppzksnark_zok_progress &progress,
+                                     const size_t chunks)
+{
+    const size_t block_size = 1ul << 12;
+    const size_t num_blocks = (num_scalars + block_size - 1) / block_size;
+
+#ifdef MULTICORE
+#pragma omp parallel for schedule(dynamic) num_threads(std::max<size_t>(chunks, 1))
+#else
+    libff::UNUSED(chunks);
+#endif
+    for (size_t b = 0; b < num_blocks; ++b)
+    {
+        const size_t begin = b * block_size;
+        const size_t end = std::min(num_scalars, begin + block_size);
+
+        std::vector<T> block(end - begin);
+        for (size_t i = begin; i < end; ++i)
+        {
+            block[i - begin] = libff::windowed_exp(scalar_size, window, table, coeff * scalars[i]);
+        }
+#ifdef USE_MIXED_ADDITION
+        libff::batch_to_special<T>(block);
+#endif
+        for (size_t i = begin; i < end; ++i)
+        {
+            result(i) = block[i - begin];
+        }
+
+        progress.add(end - begin);
+    }
+}
+
 template <typename ppT>
 r1cs_gg_ppzksnark_zok_keypair<ppT> r1cs_gg_ppzksnark_zok_generator(const r1cs_gg_ppzksnark_zok_constraint_system<ppT> &r1cs)
+{
+    return r1cs_gg_ppzksnark_zok_generator<ppT>(r1cs_gg_ppzksnark_zok_constraint_system<ppT>(r1cs));
+}
+
+template <typename ppT>
+r1cs_gg_ppzksnark_zok_keypair<ppT> r1cs_gg_ppzksnark_zok_generator(r1cs_gg_ppzksnark_zok_constraint_system<ppT> &&r1cs)
 {
     libff::enter_block("Call to r1cs_gg_ppzksnark_zok_generator");
 
     /* Make the B_query "lighter" if possible */
-    r1cs_gg_ppzksnark_zok_constraint_system<ppT> r1cs_copy(r1cs);
+    r1cs_gg_ppzksnark_zok_constraint_system<ppT> r1cs_copy(std::move(r1cs));
     r1cs_copy.swap_AB_if_beneficial();
 
     /* Generate secret randomness */
@@ -235,29 +540,26 @@ r1cs_gg_ppzksnark_zok_keypair<ppT> r1cs_gg_ppzksnark_zok_generator(const r1cs_gg
     const libff::Fr<ppT> gamma_inverse = gamma.inverse();
     const libff::Fr<ppT> delta_inverse = delta.inverse();
 
-    /* A quadratic arithmetic program evaluated at t. */
-    qap_instance_evaluation<libff::Fr<ppT> > qap = r1cs_to_qap_instance_map_with_evaluation(r1cs_copy, t);
+    /* The QAP is evaluated from the constraint matrices of the key, the
+       copy of the constraint system is not needed afterwards */
+    libff::enter_block("Compute constraint matrices for R1CS proving key");
+    r1cs_gg_ppzksnark_zok_constraint_matrices<ppT> constraint_matrices(r1cs_copy);
+    r1cs_copy = r1cs_gg_ppzksnark_zok_constraint_system<ppT>();
+    libff::leave_block("Compute constraint matrices for R1CS proving key");
+
+    /* A quadratic arithmetic program evaluated at t, with the densities of
+       A and B */
+    libff::bit_vector At_density;
+    libff::bit_vector Bt_density;
+    qap_instance_evaluation<libff::Fr<ppT> > qap = r1cs_csr_to_qap_instance_map_with_evaluation(constraint_matrices, t, At_density, Bt_density);
 
     libff::print_indent(); printf("* QAP number of variables: %zu\n", qap.num_variables());
-    libff::print_indent(); printf("* QAP pre degree: %zu\n", r1cs_copy.constraints.size());
+    libff::print_indent(); printf("* QAP pre degree: %zu\n", constraint_matrices.num_constraints());
     libff::print_indent(); printf("* QAP degree: %zu\n", qap.degree());
     libff::print_indent(); printf("* QAP number of input variables: %zu\n", qap.num_inputs());
 
-    libff::enter_block("Compute query densities");
-    size_t non_zero_At = 0;
-    size_t non_zero_Bt = 0;
-    for (size_t i = 0; i < qap.num_variables() + 1; ++i)
-    {
-        if (!qap.At[i].is_zero())
-        {
-            ++non_zero_At;
-        }
-        if (!qap.Bt[i].is_zero())
-        {
-            ++non_zero_Bt;
-        }
-    }
-    libff::leave_block("Compute query densities");
+    const size_t non_zero_At = std::count(At_density.begin(), At_density.end(), true);
+    const size_t non_zero_Bt = std::count(Bt_density.begin(), Bt_density.end(), true);
 
     /* qap.{At,Bt,Ct,Ht} are now in unspecified state, but we do not use them later */
     libff::Fr_vector<ppT> At = std::move(qap.At);
@@ -302,25 +604,44 @@ r1cs_gg_ppzksnark_zok_keypair<ppT> r1cs_gg_ppzksnark_zok_generator(const r1cs_gg
     const size_t chunks = 1;
 #endif
 
-    libff::enter_block("Generating G1 MSM window table");
+    /* The window tables, then the queries, are independent tasks sharing
+       the threads; the time of each is reported once they have all
+       finished, their progress as they go */
+    std::vector<std::string> task_names;
+    std::vector<double> task_costs;
+    std::vector<std::function<void(const size_t)> > tasks;
+
     const libff::G1<ppT> g1_generator = libff::G1<ppT>::random_element();
     const size_t g1_scalar_count = non_zero_At + non_zero_Bt + qap.num_variables();
     const size_t g1_scalar_size = libff::Fr<ppT>::size_in_bits();
     const size_t g1_window_size = libff::get_exp_window_size<libff::G1<ppT> >(g1_scalar_count);
-
     libff::print_indent(); printf("* G1 window: %zu\n", g1_window_size);
-    libff::window_table<libff::G1<ppT> > g1_table = libff::get_window_table(g1_scalar_size, g1_window_size, g1_generator);
-    libff::leave_block("Generating G1 MSM window table");
 
-    libff::enter_block("Generating G2 MSM window table");
     const libff::G2<ppT> G2_gen = libff::G2<ppT>::random_element();
     const size_t g2_scalar_count = non_zero_Bt;
     const size_t g2_scalar_size = libff::Fr<ppT>::size_in_bits();
-    size_t g2_window_size = libff::get_exp_window_size<libff::G2<ppT> >(g2_scalar_count);
-
+    const size_t g2_window_size = libff::get_exp_window_size<libff::G2<ppT> >(g2_scalar_count);
     libff::print_indent(); printf("* G2 window: %zu\n", g2_window_size);
-    libff::window_table<libff::G2<ppT> > g2_table = libff::get_window_table(g2_scalar_size, g2_window_size, G2_gen);
-    libff::leave_block("Generating G2 MSM window table");
+
+    /* A G2 addition costs about three G1 ones */
+    libff::window_table<libff::G1<ppT> > g1_table;
+    libff::window_table<libff::G2<ppT> > g2_table;
+
+    task_names.emplace_back("Generating G1 MSM window table");
+    task_costs.emplace_back((double)(g1_scalar_size / g1_window_size + 1) * (1ul << g1_window_size));
+    tasks.emplace_back([&](const size_t task_chunks) {
+        g1_table = r1cs_gg_ppzksnark_zok_window_table(g1_scalar_size, g1_window_size, g1_generator, task_chunks);
+    });
+
+    task_names.emplace_back("Generating G2 MSM window table");
+    task_costs.emplace_back(3 * (double)(g2_scalar_size / g2_window_size + 1) * (1ul << g2_window_size));
+    tasks.emplace_back([&](const size_t task_chunks) {
+        g2_table = r1cs_gg_ppzksnark_zok_window_table(g2_scalar_size, g2_window_size, G2_gen, task_chunks);
+    });
+
+    libff::enter_block("Generating MSM window tables");
+    r1cs_gg_ppzksnark_zok_run_tasks(task_names, task_costs, tasks, chunks, chunks);
+    libff::leave_block("Generating MSM window tables");
 
     libff::enter_block("Generate R1CS proving key");
     libff::G1<ppT> alpha_g1 = alpha * g1_generator;
@@ -329,46 +650,105 @@ r1cs_gg_ppzksnark_zok_keypair<ppT> r1cs_gg_ppzksnark_zok_generator(const r1cs_gg
     libff::G1<ppT> delta_g1 = delta * g1_generator;
     libff::G2<ppT> delta_g2 = delta * G2_gen;
 
-    libff::enter_block("Generate queries");
-    libff::enter_block("Compute the A-query", false);
-    libff::G1_vector<ppT> A_query = batch_exp(g1_scalar_size, g1_window_size, g1_table, At);
-#ifdef USE_MIXED_ADDITION
-    libff::batch_to_special<libff::G1<ppT> >(A_query);
-#endif
-    libff::leave_block("Compute the A-query", false);
+    libff::G2<ppT> gamma_g2 = gamma * G2_gen;
+    libff::G1<ppT> gamma_ABC_g1_0 = gamma_ABC_0 * g1_generator;
 
-    libff::enter_block("Compute the B-query", false);
-    knowledge_commitment_vector<libff::G2<ppT>, libff::G1<ppT> > B_query = kc_batch_exp(libff::Fr<ppT>::size_in_bits(), g2_window_size, g1_window_size, g2_table, g1_table, libff::Fr<ppT>::one(), libff::Fr<ppT>::one(), Bt, chunks);
-    // NOTE: if USE_MIXED_ADDITION is defined,
-    // kc_batch_exp will convert its output to special form internally
-    libff::leave_block("Compute the B-query", false);
+    libff::enter_block("Generate queries");
 
-    libff::enter_block("Compute the H-query", false);
-    libff::G1_vector<ppT> H_query = batch_exp_with_coeff(g1_scalar_size, g1_window_size, g1_table, qap.Zt * delta_inverse, Ht);
-#ifdef USE_MIXED_ADDITION
-    libff::batch_to_special<libff::G1<ppT> >(H_query);
-#endif
-    libff::leave_block("Compute the H-query", false);
+    const libff::Fr<ppT> one = libff::Fr<ppT>::one();
+    const double g1_exp_cost = (double)g1_scalar_size / g1_window_size;
+    const double g2_exp_cost = 3 * (double)g2_scalar_size / g2_window_size;
+
+    libff::G1_vector<ppT> A_query(At.size());
+    r1cs_gg_ppzksnark_zok_progress A_progress("A-query", A_query.size());
+
+    /* B_query only holds the entries with a non-zero B_i(t); its G2 and G1
+       halves are separate tasks */
+    knowledge_commitment_vector<libff::G2<ppT>, libff::G1<ppT> > B_query;
+    B_query.domain_size_ = Bt.size();
+    libff::Fr_vector<ppT> B_scalars;
+    B_query.indices.reserve(non_zero_Bt);
+    B_scalars.reserve(non_zero_Bt);
+    for (size_t i = 0; i < Bt.size(); ++i)
+    {
+        if (Bt_density[i])
+        {
+            B_query.indices.emplace_back(i);
+            B_scalars.emplace_back(Bt[i]);
+        }
+    }
+    B_query.values.resize(B_scalars.size(), knowledge_commitment<libff::G2<ppT>, libff::G1<ppT> >(libff::G2<ppT>::zero(), libff::G1<ppT>::zero()));
+    r1cs_gg_ppzksnark_zok_progress B_g2_progress("B-query (G2)", B_scalars.size());
+    r1cs_gg_ppzksnark_zok_progress B_g1_progress("B-query (G1)", B_scalars.size());
+
+    libff::G1_vector<ppT> H_query(Ht.size());
+    r1cs_gg_ppzksnark_zok_progress H_progress("H-query", H_query.size());
+    const libff::Fr<ppT> H_coeff = qap.Zt * delta_inverse;
+
+    libff::G1_vector<ppT> L_query(Lt.size());
+    r1cs_gg_ppzksnark_zok_progress L_progress("L-query", L_query.size());
+
+    libff::G1_vector<ppT> gamma_ABC_g1_values(gamma_ABC.size());
+    r1cs_gg_ppzksnark_zok_progress gamma_ABC_progress("gamma_ABC", gamma_ABC_g1_values.size());
+
+    task_names.clear();
+    task_costs.clear();
+    tasks.clear();
+
+    task_names.emplace_back("Compute the A-query");
+    task_costs.emplace_back(g1_exp_cost * A_query.size());
+    tasks.emplace_back([&](const size_t task_chunks) {
+        r1cs_gg_ppzksnark_zok_batch_exp(g1_scalar_size, g1_window_size, g1_table, one, At.begin(), At.size(),
+                                        [&](const size_t i) -> libff::G1<ppT>& { return A_query[i]; },
+                                        A_progress, task_chunks);
+    });
+
+    task_names.emplace_back("Compute the B-query (G2)");
+    task_costs.emplace_back(g2_exp_cost * B_scalars.size());
+    tasks.emplace_back([&](const size_t task_chunks) {
+        r1cs_gg_ppzksnark_zok_batch_exp(g2_scalar_size, g2_window_size, g2_table, one, B_scalars.begin(), B_scalars.size(),
+                                        [&](const size_t i) -> libff::G2<ppT>& { return B_query.values[i].g; },
+                                        B_g2_progress, task_chunks);
+    });
+
+    task_names.emplace_back("Compute the B-query (G1)");
+    task_costs.emplace_back(g1_exp_cost * B_scalars.size());
+    tasks.emplace_back([&](const size_t task_chunks) {
+        r1cs_gg_ppzksnark_zok_batch_exp(g1_scalar_size, g1_window_size, g1_table, one, B_scalars.begin(), B_scalars.size(),
+                                        [&](const size_t i) -> libff::G1<ppT>& { return B_query.values[i].h; },
+                                        B_g1_progress, task_chunks);
+    });
+
+    task_names.emplace_back("Compute the H-query");
+    task_costs.emplace_back(g1_exp_cost * H_query.size());
+    tasks.emplace_back([&](const size_t task_chunks) {
+        r1cs_gg_ppzksnark_zok_batch_exp(g1_scalar_size, g1_window_size, g1_table, H_coeff, Ht.begin(), Ht.size(),
+                                        [&](const size_t i) -> libff::G1<ppT>& { return H_query[i]; },
+                                        H_progress, task_chunks);
+    });
+
+    task_names.emplace_back("Compute the L-query");
+    task_costs.emplace_back(g1_exp_cost * L_query.size());
+    tasks.emplace_back([&](const size_t task_chunks) {
+        r1cs_gg_ppzksnark_zok_batch_exp(g1_scalar_size, g1_window_size, g1_table, one, Lt.begin(), Lt.size(),
+                                        [&](const size_t i) -> libff::G1<ppT>& { return L_query[i]; },
+                                        L_progress, task_chunks);
+    });
+
+    task_names.emplace_back("Encode gamma_ABC for R1CS verification key");
+    task_costs.emplace_back(g1_exp_cost * gamma_ABC_g1_values.size());
+    tasks.emplace_back([&](const size_t task_chunks) {
+        r1cs_gg_ppzksnark_zok_batch_exp(g1_scalar_size, g1_window_size, g1_table, one, gamma_ABC.begin(), gamma_ABC.size(),
+                                        [&](const size_t i) -> libff::G1<ppT>& { return gamma_ABC_g1_values[i]; },
+                                        gamma_ABC_progress, task_chunks);
+    });
+
+    r1cs_gg_ppzksnark_zok_run_tasks(task_names, task_costs, tasks, chunks, chunks);
 
-    libff::enter_block("Compute the L-query", false);
-    libff::G1_vector<ppT> L_query = batch_exp(g1_scalar_size, g1_window_size, g1_table, Lt);
-#ifdef USE_MIXED_ADDITION
-    libff::batch_to_special<libff::G1<ppT> >(L_query);
-#endif
-    libff::leave_block("Compute the L-query", false);
     libff::leave_block("Generate queries");
 
     libff::leave_block("Generate R1CS proving key");
 
-    libff::enter_block("Generate R1CS verification key");
-    libff::G2<ppT> gamma_g2 = gamma * G2_gen;
-
-    libff::enter_block("Encode gamma_ABC for R1CS verification key");
-    libff::G1<ppT> gamma_ABC_g1_0 = gamma_ABC_0 * g1_generator;
-    libff::G1_vector<ppT> gamma_ABC_g1_values = batch_exp(g1_scalar_size, g1_window_size, g1_table, gamma_ABC);
-    libff::leave_block("Encode gamma_ABC for R1CS verification key");
-    libff::leave_block("Generate R1CS verification key");
-
     libff::leave_block("Call to r1cs_gg_ppzksnark_zok_generator");
 
     accumulation_vector<libff::G1<ppT> > gamma_ABC_g1(std::move(gamma_ABC_g1_0), std::move(gamma_ABC_g1_values));
@@ -384,11 +764,12 @@ r1cs_gg_ppzksnark_zok_keypair<ppT> r1cs_gg_ppzksnark_zok_generator(const r1cs_gg
                                                                                std::move(beta_g2),
                                                                                std::move(delta_g1),
                                                                                std::move(delta_g2),
+                                                                               std::move(At_density),
                                                                                std::move(A_query),
                                                                                std::move(B_query),
                                                                                std::move(H_query),
                                                                                std::move(L_query),
-                                                                               std::move(r1cs_copy));
+                                                                               std::move(constraint_matrices));
 
     pk.print_size();
     vk.print_size();
@@ -396,43 +777,248 @@ r1cs_gg_ppzksnark_zok_keypair<ppT> r1cs_gg_ppzksnark_zok_generator(const r1cs_gg
     return r1cs_gg_ppzksnark_zok_keypair<ppT>(std::move(pk), std::move(vk));
 }
 
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_prover_context<ppT>::r1cs_gg_ppzksnark_zok_prover_context(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk) :
+    domain(pk.constraint_matrices.num_constraints() + pk.constraint_matrices.num_inputs() + 1, true),
+    /* 43 additions per exponentiation, from tables of about 2700 points */
+    blinding_window_size(6)
+{
+    const size_t num_bits = libff::Fr<ppT>::size_in_bits();
+
+    alpha_g1_table = libff::get_window_table(num_bits, blinding_window_size, pk.alpha_g1);
+    beta_g1_table = libff::get_window_table(num_bits, blinding_window_size, pk.beta_g1);
+    delta_g1_table = libff::get_window_table(num_bits, blinding_window_size, pk.delta_g1);
+    delta_g2_table = libff::get_window_table(num_bits, blinding_window_size, pk.delta_g2);
+}
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_expanded_proving_key<ppT>::r1cs_gg_ppzksnark_zok_expanded_proving_key(r1cs_gg_ppzksnark_zok_proving_key<ppT> &&pk,
+                                                                                         const size_t max_table_bytes) :
+    pk(std::move(pk)),
+    context(this->pk)
+{
+    libff::enter_block("Call to r1cs_gg_ppzksnark_zok_expanded_proving_key");
+
+    const size_t num_bases = this->pk.A_query.size() + this->pk.H_query.size() + this->pk.L_query.size();
+    const size_t max_multiples_per_base = max_table_bytes / (sizeof(libff::G1<ppT>) * std::max<size_t>(num_bases, 1));
+    const size_t num_bits = libff::Fr<ppT>::size_in_bits();
+
+    libff::enter_block("Compute A-query table", false);
+    A_table = pippenger_fixed_base_table<libff::G1<ppT> >(this->pk.A_query.begin(), this->pk.A_query.end(), num_bits, max_multiples_per_base);
+    libff::leave_block("Compute A-query table", false);
+
+    libff::enter_block("Compute H-query table", false);
+    H_table = pippenger_fixed_base_table<libff::G1<ppT> >(this->pk.H_query.begin(), this->pk.H_query.end(), num_bits, max_multiples_per_base);
+    libff::leave_block("Compute H-query table", false);
+
+    libff::enter_block("Compute L-query table", false);
+    L_table = pippenger_fixed_base_table<libff::G1<ppT> >(this->pk.L_query.begin(), this->pk.L_query.end(), num_bits, max_multiples_per_base);
+    libff::leave_block("Compute L-query table", false);
+
+    libff::leave_block("Call to r1cs_gg_ppzksnark_zok_expanded_proving_key");
+
+    this->print_size();
+    this->context.print_size();
+}
+
+/**
+ * Combine the query evaluations of a single witness with the blinding
+ * factors r and s into a proof, with the window tables of `context` when
+ * it is not null.
+ */
 template <typename ppT>
-r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk,
-                                                      const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
-                                                      const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input)
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_assemble_proof(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk,
+                                                                      const r1cs_gg_ppzksnark_zok_prover_context<ppT> *context,
+                                                                      const libff::G1<ppT> &evaluation_At,
+                                                                      const knowledge_commitment<libff::G2<ppT>, libff::G1<ppT> > &evaluation_Bt,
+                                                                      const libff::G1<ppT> &evaluation_Ht,
+                                                                      const libff::G1<ppT> &evaluation_Lt,
+                                                                      const libff::Fr<ppT> &r,
+                                                                      const libff::Fr<ppT> &s)
 {
-    libff::enter_block("Call to r1cs_gg_ppzksnark_zok_prover");
+    const auto r_bigint = r.as_bigint();
+    const auto s_bigint = s.as_bigint();
 
-#ifdef DEBUG
-    assert(pk.constraint_system.is_satisfied(primary_input, auxiliary_input));
-#endif
+    if (context != nullptr)
+    {
+        const size_t num_bits = libff::Fr<ppT>::size_in_bits();
+        const size_t window = context->blinding_window_size;
 
-    libff::enter_block("Compute the polynomial H");
-    const qap_witness<libff::Fr<ppT> > qap_wit = r1cs_to_qap_witness_map(pk.constraint_system, primary_input, auxiliary_input, libff::Fr<ppT>::zero(), libff::Fr<ppT>::zero(), libff::Fr<ppT>::zero());
+        /* A = alpha + sum_i(a_i*A_i(t)) + r*delta */
+        libff::G1<ppT> g1_A = pk.alpha_g1 + evaluation_At + libff::windowed_exp(num_bits, window, context->delta_g1_table, r);
+
+        /* B = beta + sum_i(a_i*B_i(t)) + s*delta */
+        libff::G2<ppT> g2_B = pk.beta_g2 + evaluation_Bt.g + libff::windowed_exp(num_bits, window, context->delta_g2_table, s);
+
+        /* C as below, with s*A + r*B - r*s*delta expanded so that only the
+           evaluations are variable bases:
+           s*sum_i(a_i*A_i(t)) + r*sum_i(a_i*B_i(t)) + s*alpha + r*beta + r*s*delta */
+        libff::G1<ppT> g1_C = evaluation_Ht + evaluation_Lt
+            + glv_scalar_mul(evaluation_At, s_bigint) + glv_scalar_mul(evaluation_Bt.h, r_bigint)
+            + libff::windowed_exp(num_bits, window, context->alpha_g1_table, s)
+            + libff::windowed_exp(num_bits, window, context->beta_g1_table, r)
+            + libff::windowed_exp(num_bits, window, context->delta_g1_table, r * s);
+
+        return r1cs_gg_ppzksnark_zok_proof<ppT>(std::move(g1_A), std::move(g2_B), std::move(g1_C));
+    }
+
+    /* A = alpha + sum_i(a_i*A_i(t)) + r*delta */
+    libff::G1<ppT> g1_A = pk.alpha_g1 + evaluation_At + glv_scalar_mul(pk.delta_g1, r_bigint);
+
+    /* B = beta + sum_i(a_i*B_i(t)) + s*delta */
+    libff::G1<ppT> g1_B = pk.beta_g1 + evaluation_Bt.h + glv_scalar_mul(pk.delta_g1, s_bigint);
+    libff::G2<ppT> g2_B = pk.beta_g2 + evaluation_Bt.g + s * pk.delta_g2;
+
+    /* C = sum_i(a_i*((beta*A_i(t) + alpha*B_i(t) + C_i(t)) + H(t)*Z(t))/delta) + A*s + r*b - r*s*delta */
+    libff::G1<ppT> g1_C = evaluation_Ht + evaluation_Lt + glv_scalar_mul(g1_A, s_bigint) + glv_scalar_mul(g1_B, r_bigint)
+        - glv_scalar_mul(pk.delta_g1, (r * s).as_bigint());
+
+    return r1cs_gg_ppzksnark_zok_proof<ppT>(std::move(g1_A), std::move(g2_B), std::move(g1_C));
+}
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_blinding_factors<ppT> r1cs_gg_ppzksnark_zok_blinding_factors<ppT>::random()
+{
+    return r1cs_gg_ppzksnark_zok_blinding_factors<ppT>(libff::Fr<ppT>::random_element(), libff::Fr<ppT>::random_element());
+}
+
+/**
+ * A field element of size_in_bits() - 1 random bits from `generator`, so
+ * that it is below the modulus.
+ */
+template<typename FieldT>
+FieldT r1cs_gg_ppzksnark_zok_seeded_element(std::mt19937_64 &generator)
+{
+    libff::bigint<FieldT::num_limbs> value;
+    for (mp_size_t i = 0; i < FieldT::num_limbs; ++i)
+    {
+        value.data[i] = generator();
+    }
+
+    const size_t num_bits = FieldT::size_in_bits() - 1;
+    for (mp_size_t i = num_bits / GMP_NUMB_BITS; i < FieldT::num_limbs; ++i)
+    {
+        const size_t low_bits = (i == (mp_size_t)(num_bits / GMP_NUMB_BITS)) ? num_bits % GMP_NUMB_BITS : 0;
+        value.data[i] &= (((mp_limb_t)1) << low_bits) - 1;
+    }
+
+    return FieldT(value);
+}
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_blinding_factors<ppT> r1cs_gg_ppzksnark_zok_blinding_factors<ppT>::from_seed(const uint64_t seed)
+{
+    std::mt19937_64 generator(seed);
+    const libff::Fr<ppT> r = r1cs_gg_ppzksnark_zok_seeded_element<libff::Fr<ppT> >(generator);
+    const libff::Fr<ppT> s = r1cs_gg_ppzksnark_zok_seeded_element<libff::Fr<ppT> >(generator);
+
+    return r1cs_gg_ppzksnark_zok_blinding_factors<ppT>(r, s);
+}
+
+/**
+ * Computes the coefficients of H for `const_padded_assignment` in the
+ * buffers of `workspace`, over the domain of `context` when it is not null,
+ * and evaluates the H-query on them, with the table of `epk` when it is not
+ * null and the table is not empty.
+ */
+template <typename ppT>
+libff::G1<ppT> r1cs_gg_ppzksnark_zok_evaluate_H_query(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk,
+                                                      const r1cs_gg_ppzksnark_zok_prover_context<ppT> *context,
+                                                      r1cs_gg_ppzksnark_zok_prover_workspace<ppT> &workspace,
+                                                      const r1cs_gg_ppzksnark_zok_expanded_proving_key<ppT> *epk,
+                                                      const r1cs_padded_assignment<libff::Fr<ppT> > &const_padded_assignment,
+                                                      const r1cs_gg_ppzksnark_zok_prover_config &config,
+                                                      const size_t chunks)
+{
+    if (context != nullptr)
+    {
+        r1cs_csr_to_qap_H_coefficients(pk.constraint_matrices, const_padded_assignment, context->domain,
+                                       workspace.H, workspace.H_scratch);
+    }
+    else
+    {
+        const qap_evaluation_domain<libff::Fr<ppT> > domain(pk.constraint_matrices.num_constraints() + pk.constraint_matrices.num_inputs() + 1, false);
+        r1cs_csr_to_qap_H_coefficients(pk.constraint_matrices, const_padded_assignment, domain,
+                                       workspace.H, workspace.H_scratch);
+    }
+
+    const libff::Fr_vector<ppT> &coefficients_for_H = workspace.H;
+    const size_t degree = coefficients_for_H.size() - 1;
 
     /* We are dividing degree 2(d-1) polynomial by degree d polynomial
        and not adding a PGHR-style ZK-patch, so our H is degree d-2 */
-    assert(!qap_wit.coefficients_for_H[qap_wit.degree()-2].is_zero());
-    assert(qap_wit.coefficients_for_H[qap_wit.degree()-1].is_zero());
-    assert(qap_wit.coefficients_for_H[qap_wit.degree()].is_zero());
-    libff::leave_block("Compute the polynomial H");
+    assert(!coefficients_for_H[degree-2].is_zero());
+    assert(coefficients_for_H[degree-1].is_zero());
+    assert(coefficients_for_H[degree].is_zero());
 
 #ifdef DEBUG
-    const libff::Fr<ppT> t = libff::Fr<ppT>::random_element();
-    qap_instance_evaluation<libff::Fr<ppT> > qap_inst = r1cs_to_qap_instance_map_with_evaluation(pk.constraint_system, t);
-    assert(qap_inst.is_satisfied(qap_wit));
+    assert(pk.H_query.size() == degree - 1);
 #endif
 
-    /* Choose two random field elements for prover zero-knowledge. */
-    const libff::Fr<ppT> r = libff::Fr<ppT>::random_element();
-    const libff::Fr<ppT> s = libff::Fr<ppT>::random_element();
+    if (epk != nullptr && !epk->H_table.empty())
+    {
+        return epk->H_table.template multi_exp<libff::Fr<ppT> >(
+            pk.H_query.begin(),
+            coefficients_for_H.begin(),
+            coefficients_for_H.begin() + (degree - 1),
+            chunks);
+    }
+    else if (config.H_query_method == r1cs_gg_ppzksnark_zok_multi_exp_pippenger)
+    {
+        return pippenger_multi_exp<libff::G1<ppT>, libff::Fr<ppT> >(
+            pk.H_query.begin(),
+            pk.H_query.begin() + (degree - 1),
+            coefficients_for_H.begin(),
+            coefficients_for_H.begin() + (degree - 1),
+            chunks);
+    }
+    else
+    {
+        return libff::multi_exp<libff::G1<ppT>,
+                                libff::Fr<ppT>,
+                                libff::multi_exp_method_BDLO12>(
+            pk.H_query.begin(),
+            pk.H_query.begin() + (degree - 1),
+            coefficients_for_H.begin(),
+            coefficients_for_H.begin() + (degree - 1),
+            chunks);
+    }
+}
+
+/**
+ * Prover shared by the plain and expanded proving keys; `epk` is null when
+ * no precomputed tables are available, and `context` when the evaluation
+ * domain has to be prepared for this proof.
+ */
+template <typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover_internal(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk,
+                                                               const r1cs_gg_ppzksnark_zok_prover_context<ppT> *context,
+                                                               r1cs_gg_ppzksnark_zok_prover_workspace<ppT> &workspace,
+                                                               const r1cs_gg_ppzksnark_zok_expanded_proving_key<ppT> *epk,
+                                                               const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                               const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                                               const r1cs_gg_ppzksnark_zok_blinding_factors<ppT> &blinding,
+                                                               const r1cs_gg_ppzksnark_zok_prover_config &config)
+{
+    libff::enter_block("Call to r1cs_gg_ppzksnark_zok_prover");
 
 #ifdef DEBUG
-    assert(qap_wit.coefficients_for_ABCs.size() == qap_wit.num_variables());
-    assert(pk.A_query.size() == qap_wit.num_variables()+1);
-    assert(pk.B_query.domain_size() == qap_wit.num_variables()+1);
-    assert(pk.H_query.size() == qap_wit.degree() - 1);
-    assert(pk.L_query.size() == qap_wit.num_variables() - qap_wit.num_inputs());
+    assert(pk.constraint_matrices.is_satisfied(primary_input, auxiliary_input));
+#endif
+
+    const size_t num_variables = pk.constraint_matrices.num_variables();
+    const size_t num_inputs = pk.constraint_matrices.num_inputs();
+    const size_t num_bits = libff::Fr<ppT>::size_in_bits();
+
+    /* Two field elements, random unless chosen by the caller, for prover zero-knowledge. */
+    const libff::Fr<ppT> &r = blinding.r;
+    const libff::Fr<ppT> &s = blinding.s;
+
+#ifdef DEBUG
+    assert(primary_input.size() + auxiliary_input.size() == num_variables);
+    assert(pk.A_query.size() == num_variables+1);
+    assert(pk.B_query.domain_size() == num_variables+1);
+    assert(pk.L_query.size() == num_variables - num_inputs);
 #endif
 
 #ifdef MULTICORE
@@ -443,74 +1029,378 @@ r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(const r1cs_gg_ppzk
 
     libff::enter_block("Compute the proof");
 
-    libff::enter_block("Compute evaluation to A-query", false);
-    // TODO: sort out indexing
-    libff::Fr_vector<ppT> const_padded_assignment(1, libff::Fr<ppT>::one());
-    const_padded_assignment.insert(const_padded_assignment.end(), qap_wit.coefficients_for_ABCs.begin(), qap_wit.coefficients_for_ABCs.end());
+    /* The A, B and L queries only depend on the assignment, not on H, so
+       they are set up before the QAP witness is computed */
+    libff::enter_block("Compute witness density", false);
+
+    /* (1, x_1, ..., x_n), read from the inputs without copying them */
+    const r1cs_padded_assignment<libff::Fr<ppT> > const_padded_assignment(primary_input, auxiliary_input);
+
+    /* Classify every scalar once; the A, B and L queries skip the zeros
+       and add the bases of ones directly */
+    const scalar_density<libff::Fr<ppT> > density(const_padded_assignment.begin(), const_padded_assignment.begin() + num_variables + 1);
+    density.print();
 
-    libff::G1<ppT> evaluation_At = libff::multi_exp_with_mixed_addition<libff::G1<ppT>,
-                                                                        libff::Fr<ppT>,
-                                                                        libff::multi_exp_method_BDLO12>(
+    const bool use_A_table = (epk != nullptr && !epk->A_table.empty());
+    const bool use_L_table = (epk != nullptr && !epk->L_table.empty());
+
+    const multi_exp_density_plan<libff::Fr<ppT> > A_plan(density, const_padded_assignment.begin(), use_A_table ? 0 : num_variables + 1, multi_exp_offset_index(0),
+                                                         config.A_query_method == r1cs_gg_ppzksnark_zok_multi_exp_pippenger, &pk.A_density);
+    const multi_exp_density_plan<libff::Fr<ppT> > L_plan(density, const_padded_assignment.begin(), use_L_table ? 0 : pk.L_query.size(), multi_exp_offset_index(num_inputs + 1),
+                                                         config.L_query_method == r1cs_gg_ppzksnark_zok_multi_exp_pippenger);
+
+    /* B_query only holds the non-zero entries, whose indices are sorted */
+    const size_t B_num_bases = std::lower_bound(pk.B_query.indices.begin(), pk.B_query.indices.end(), num_variables + 1) - pk.B_query.indices.begin();
+    const multi_exp_density_plan<libff::Fr<ppT> > B_plan(density, const_padded_assignment.begin(), B_num_bases, multi_exp_sparse_index(pk.B_query.indices),
+                                                         config.B_query_method == r1cs_gg_ppzksnark_zok_multi_exp_pippenger);
+
+    if (!use_A_table)
+    {
+        A_plan.print("A");
+    }
+    B_plan.print("B");
+    if (!use_L_table)
+    {
+        L_plan.print("L");
+    }
+    libff::leave_block("Compute witness density", false);
+
+    libff::G1<ppT> evaluation_At;
+    libff::G2<ppT> evaluation_Bt_g;
+    libff::G1<ppT> evaluation_Bt_h;
+    libff::G1<ppT> evaluation_Ht;
+    libff::G1<ppT> evaluation_Lt;
+
+    /* Every task below writes a single result and, apart from the H task,
+       does not touch the (non thread-safe) profiling state. */
+    std::vector<std::string> task_names;
+    std::vector<double> task_costs;
+    std::vector<std::function<void(const size_t)> > tasks;
+
+    task_names.emplace_back("Compute the polynomial H and evaluation to H-query");
+    task_costs.emplace_back(r1cs_gg_ppzksnark_zok_multi_exp_cost(0, pk.H_query.size(), num_bits) +
+                            r1cs_gg_ppzksnark_zok_fft_cost(pk.H_query.size()));
+    tasks.emplace_back([&](const size_t task_chunks) {
+        evaluation_Ht = r1cs_gg_ppzksnark_zok_evaluate_H_query<ppT>(pk, context, workspace, epk, const_padded_assignment, config, task_chunks);
+    });
+
+    task_names.emplace_back("Compute evaluation to A-query");
+    task_costs.emplace_back(use_A_table ? r1cs_gg_ppzksnark_zok_multi_exp_cost(0, num_variables + 1, num_bits)
+                                        : r1cs_gg_ppzksnark_zok_multi_exp_cost(A_plan.one_bases.size(), A_plan.dense_bases.size(), num_bits));
+    tasks.emplace_back([&](const size_t task_chunks) {
+        if (use_A_table)
+        {
+            evaluation_At = epk->A_table.template multi_exp<libff::Fr<ppT> >(
+                pk.A_query.begin(),
+                const_padded_assignment.begin(),
+                const_padded_assignment.begin() + num_variables + 1,
+                task_chunks);
+        }
+        else
+        {
+            evaluation_At = multi_exp_with_density<libff::G1<ppT> >(
+                A_plan,
+                pippenger_vector_accessor<libff::G1<ppT> >(pk.A_query.begin()),
+                task_chunks);
+        }
+    });
+
+    /* The G2 half of B is the most expensive multi-exponentiation per base,
+       it gets a task of its own */
+    const double B_cost = r1cs_gg_ppzksnark_zok_multi_exp_cost(B_plan.one_bases.size(), B_plan.dense_bases.size(), num_bits);
+
+    task_names.emplace_back("Compute evaluation to B-query (G2)");
+    task_costs.emplace_back(3 * B_cost);
+    tasks.emplace_back([&](const size_t task_chunks) {
+        evaluation_Bt_g = multi_exp_with_density<libff::G2<ppT> >(
+            B_plan,
+            pippenger_kc_g_accessor<libff::G2<ppT>, libff::G1<ppT> >(pk.B_query.values, 0),
+            task_chunks);
+    });
+
+    task_names.emplace_back("Compute evaluation to B-query (G1)");
+    task_costs.emplace_back(B_cost);
+    tasks.emplace_back([&](const size_t task_chunks) {
+        evaluation_Bt_h = multi_exp_with_density<libff::G1<ppT> >(
+            B_plan,
+            pippenger_kc_h_accessor<libff::G2<ppT>, libff::G1<ppT> >(pk.B_query.values, 0),
+            task_chunks);
+    });
+
+    task_names.emplace_back("Compute evaluation to L-query");
+    task_costs.emplace_back(use_L_table ? r1cs_gg_ppzksnark_zok_multi_exp_cost(0, pk.L_query.size(), num_bits)
+                                        : r1cs_gg_ppzksnark_zok_multi_exp_cost(L_plan.one_bases.size(), L_plan.dense_bases.size(), num_bits));
+    tasks.emplace_back([&](const size_t task_chunks) {
+        if (use_L_table)
+        {
+            evaluation_Lt = epk->L_table.template multi_exp<libff::Fr<ppT> >(
+                pk.L_query.begin(),
+                const_padded_assignment.begin() + num_inputs + 1,
+                const_padded_assignment.begin() + num_variables + 1,
+                task_chunks);
+        }
+        else
+        {
+            evaluation_Lt = multi_exp_with_density<libff::G1<ppT> >(
+                L_plan,
+                pippenger_vector_accessor<libff::G1<ppT> >(pk.L_query.begin()),
+                task_chunks);
+        }
+    });
+
+    r1cs_gg_ppzksnark_zok_run_tasks(task_names, task_costs, tasks, config.overlap_tasks ? chunks : 1, chunks);
+
+    const knowledge_commitment<libff::G2<ppT>, libff::G1<ppT> > evaluation_Bt(evaluation_Bt_g, evaluation_Bt_h);
+
+    r1cs_gg_ppzksnark_zok_proof<ppT> proof = r1cs_gg_ppzksnark_zok_assemble_proof<ppT>(pk, context, evaluation_At, evaluation_Bt, evaluation_Ht, evaluation_Lt, r, s);
+
+    libff::leave_block("Compute the proof");
+
+    libff::leave_block("Call to r1cs_gg_ppzksnark_zok_prover");
+
+    proof.print_size();
+
+    return proof;
+}
+
+template <typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk,
+                                                      const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                      const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input)
+{
+    return r1cs_gg_ppzksnark_zok_prover<ppT>(pk, primary_input, auxiliary_input, r1cs_gg_ppzksnark_zok_prover_config());
+}
+
+template <typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk,
+                                                      const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                      const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                                      const r1cs_gg_ppzksnark_zok_prover_config &config)
+{
+    r1cs_gg_ppzksnark_zok_prover_workspace<ppT> workspace;
+    return r1cs_gg_ppzksnark_zok_prover_internal<ppT>(pk, nullptr, workspace, nullptr, primary_input, auxiliary_input, r1cs_gg_ppzksnark_zok_blinding_factors<ppT>::random(), config);
+}
+
+template <typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk,
+                                                      const r1cs_gg_ppzksnark_zok_prover_context<ppT> &context,
+                                                      const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                      const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                                      const r1cs_gg_ppzksnark_zok_prover_config &config)
+{
+    r1cs_gg_ppzksnark_zok_prover_workspace<ppT> workspace;
+    return r1cs_gg_ppzksnark_zok_prover_internal<ppT>(pk, &context, workspace, nullptr, primary_input, auxiliary_input, r1cs_gg_ppzksnark_zok_blinding_factors<ppT>::random(), config);
+}
+
+template <typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk,
+                                                      const r1cs_gg_ppzksnark_zok_prover_context<ppT> &context,
+                                                      r1cs_gg_ppzksnark_zok_prover_workspace<ppT> &workspace,
+                                                      const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                      const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                                      const r1cs_gg_ppzksnark_zok_prover_config &config)
+{
+    return r1cs_gg_ppzksnark_zok_prover_internal<ppT>(pk, &context, workspace, nullptr, primary_input, auxiliary_input, r1cs_gg_ppzksnark_zok_blinding_factors<ppT>::random(), config);
+}
+
+template <typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(const r1cs_gg_ppzksnark_zok_expanded_proving_key<ppT> &epk,
+                                                      const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                      const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                                      const r1cs_gg_ppzksnark_zok_prover_config &config)
+{
+    r1cs_gg_ppzksnark_zok_prover_workspace<ppT> workspace;
+    return r1cs_gg_ppzksnark_zok_prover_internal<ppT>(epk.pk, &epk.context, workspace, &epk, primary_input, auxiliary_input, r1cs_gg_ppzksnark_zok_blinding_factors<ppT>::random(), config);
+}
+
+template <typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(const r1cs_gg_ppzksnark_zok_expanded_proving_key<ppT> &epk,
+                                                      r1cs_gg_ppzksnark_zok_prover_workspace<ppT> &workspace,
+                                                      const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                      const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                                      const r1cs_gg_ppzksnark_zok_prover_config &config)
+{
+    return r1cs_gg_ppzksnark_zok_prover_internal<ppT>(epk.pk, &epk.context, workspace, &epk, primary_input, auxiliary_input, r1cs_gg_ppzksnark_zok_blinding_factors<ppT>::random(), config);
+}
+
+template <typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk,
+                                                      const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                      const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                                      const r1cs_gg_ppzksnark_zok_blinding_factors<ppT> &blinding,
+                                                      const r1cs_gg_ppzksnark_zok_prover_config &config)
+{
+    r1cs_gg_ppzksnark_zok_prover_workspace<ppT> workspace;
+    return r1cs_gg_ppzksnark_zok_prover_internal<ppT>(pk, nullptr, workspace, nullptr, primary_input, auxiliary_input, blinding, config);
+}
+
+template <typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk,
+                                                      const r1cs_gg_ppzksnark_zok_prover_context<ppT> &context,
+                                                      r1cs_gg_ppzksnark_zok_prover_workspace<ppT> &workspace,
+                                                      const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                      const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                                      const r1cs_gg_ppzksnark_zok_blinding_factors<ppT> &blinding,
+                                                      const r1cs_gg_ppzksnark_zok_prover_config &config)
+{
+    return r1cs_gg_ppzksnark_zok_prover_internal<ppT>(pk, &context, workspace, nullptr, primary_input, auxiliary_input, blinding, config);
+}
+
+template <typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(const r1cs_gg_ppzksnark_zok_expanded_proving_key<ppT> &epk,
+                                                      r1cs_gg_ppzksnark_zok_prover_workspace<ppT> &workspace,
+                                                      const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                      const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                                      const r1cs_gg_ppzksnark_zok_blinding_factors<ppT> &blinding,
+                                                      const r1cs_gg_ppzksnark_zok_prover_config &config)
+{
+    return r1cs_gg_ppzksnark_zok_prover_internal<ppT>(epk.pk, &epk.context, workspace, &epk, primary_input, auxiliary_input, blinding, config);
+}
+
+template <typename ppT>
+std::vector<r1cs_gg_ppzksnark_zok_proof<ppT> > r1cs_gg_ppzksnark_zok_batch_prover(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk,
+                                                                                  const std::vector<r1cs_gg_ppzksnark_zok_primary_input<ppT> > &primary_inputs,
+                                                                                  const std::vector<r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> > &auxiliary_inputs)
+{
+    /* Fresh blinding factors for every proof in the batch */
+    std::vector<r1cs_gg_ppzksnark_zok_blinding_factors<ppT> > blinding;
+    blinding.reserve(primary_inputs.size());
+    for (size_t w = 0; w < primary_inputs.size(); ++w)
+    {
+        blinding.emplace_back(r1cs_gg_ppzksnark_zok_blinding_factors<ppT>::random());
+    }
+
+    return r1cs_gg_ppzksnark_zok_batch_prover<ppT>(pk, primary_inputs, auxiliary_inputs, blinding);
+}
+
+template <typename ppT>
+std::vector<r1cs_gg_ppzksnark_zok_proof<ppT> > r1cs_gg_ppzksnark_zok_batch_prover(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk,
+                                                                                  const std::vector<r1cs_gg_ppzksnark_zok_primary_input<ppT> > &primary_inputs,
+                                                                                  const std::vector<r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> > &auxiliary_inputs,
+                                                                                  const std::vector<r1cs_gg_ppzksnark_zok_blinding_factors<ppT> > &blinding)
+{
+    libff::enter_block("Call to r1cs_gg_ppzksnark_zok_batch_prover");
+
+    assert(primary_inputs.size() == auxiliary_inputs.size());
+    assert(blinding.size() == primary_inputs.size());
+    const size_t batch_size = primary_inputs.size();
+    const size_t num_variables = pk.constraint_matrices.num_variables();
+    const size_t num_inputs = pk.constraint_matrices.num_inputs();
+    size_t degree = 0;
+
+    libff::print_indent(); printf("* Witnesses in batch: %zu\n", batch_size);
+
+    typedef typename libff::Fr_vector<ppT>::const_iterator scalar_iterator;
+    typedef typename r1cs_padded_assignment<libff::Fr<ppT> >::const_iterator assignment_iterator;
+
+    /* Per-witness views of the padded assignment (1, x_1, ..., x_n), which
+       the iterators below refer to, and coefficients of H */
+    std::vector<std::unique_ptr<r1cs_padded_assignment<libff::Fr<ppT> > > > padded_assignments;
+    std::vector<libff::Fr_vector<ppT> > coefficients_for_H(batch_size);
+    padded_assignments.reserve(batch_size);
+
+    libff::enter_block("Compute the polynomial H");
+
+    /* The evaluation domain is prepared once for the whole batch */
+    const r1cs_gg_ppzksnark_zok_prover_context<ppT> context(pk);
+    libff::Fr_vector<ppT> H_scratch;
+
+    for (size_t w = 0; w < batch_size; ++w)
+    {
+#ifdef DEBUG
+        assert(pk.constraint_matrices.is_satisfied(primary_inputs[w], auxiliary_inputs[w]));
+#endif
+        padded_assignments.emplace_back(new r1cs_padded_assignment<libff::Fr<ppT> >(primary_inputs[w], auxiliary_inputs[w]));
+        r1cs_csr_to_qap_H_coefficients(pk.constraint_matrices, *padded_assignments[w], context.domain, coefficients_for_H[w], H_scratch);
+        degree = coefficients_for_H[w].size() - 1;
+
+        /* See r1cs_gg_ppzksnark_zok_prover, H is degree d-2 */
+        assert(!coefficients_for_H[w][degree-2].is_zero());
+        assert(coefficients_for_H[w][degree-1].is_zero());
+        assert(coefficients_for_H[w][degree].is_zero());
+    }
+    libff::leave_block("Compute the polynomial H");
+
+#ifdef DEBUG
+    assert(pk.A_query.size() == num_variables+1);
+    assert(pk.B_query.domain_size() == num_variables+1);
+    assert(batch_size == 0 || pk.H_query.size() == degree - 1);
+    assert(pk.L_query.size() == num_variables - num_inputs);
+#endif
+
+#ifdef MULTICORE
+    const size_t chunks = omp_get_max_threads(); // to override, set OMP_NUM_THREADS env var or call omp_set_num_threads()
+#else
+    const size_t chunks = 1;
+#endif
+
+    /* B_query is sparse, gather the scalars for its non-zero entries */
+    std::vector<libff::Fr_vector<ppT> > B_scalars(batch_size);
+    std::vector<assignment_iterator> A_scalar_starts, L_scalar_starts;
+    std::vector<scalar_iterator> B_scalar_starts, H_scalar_starts;
+
+    for (size_t w = 0; w < batch_size; ++w)
+    {
+        B_scalars[w].reserve(pk.B_query.size());
+        for (const size_t idx : pk.B_query.indices)
+        {
+            B_scalars[w].emplace_back((*padded_assignments[w])[idx]);
+        }
+
+        A_scalar_starts.emplace_back(padded_assignments[w]->begin());
+        B_scalar_starts.emplace_back(B_scalars[w].begin());
+        H_scalar_starts.emplace_back(coefficients_for_H[w].begin());
+        L_scalar_starts.emplace_back(padded_assignments[w]->begin() + num_inputs + 1);
+    }
+
+    libff::enter_block("Compute the proofs");
+
+    libff::enter_block("Compute evaluation to A-query", false);
+    const std::vector<libff::G1<ppT> > evaluation_At = multi_exp_batch<libff::G1<ppT>, libff::Fr<ppT> >(
         pk.A_query.begin(),
-        pk.A_query.begin() + qap_wit.num_variables() + 1,
-        const_padded_assignment.begin(),
-        const_padded_assignment.begin() + qap_wit.num_variables() + 1,
+        pk.A_query.begin() + num_variables + 1,
+        A_scalar_starts,
         chunks);
     libff::leave_block("Compute evaluation to A-query", false);
 
     libff::enter_block("Compute evaluation to B-query", false);
-    knowledge_commitment<libff::G2<ppT>, libff::G1<ppT> > evaluation_Bt = kc_multi_exp_with_mixed_addition<libff::G2<ppT>,
-                                                                                                           libff::G1<ppT>,
-                                                                                                           libff::Fr<ppT>,
-                                                                                                           libff::multi_exp_method_BDLO12>(
-        pk.B_query,
-        0,
-        qap_wit.num_variables() + 1,
-        const_padded_assignment.begin(),
-        const_padded_assignment.begin() + qap_wit.num_variables() + 1,
+    const std::vector<knowledge_commitment<libff::G2<ppT>, libff::G1<ppT> > > evaluation_Bt = multi_exp_batch<knowledge_commitment<libff::G2<ppT>, libff::G1<ppT> >, libff::Fr<ppT> >(
+        pk.B_query.values.begin(),
+        pk.B_query.values.end(),
+        B_scalar_starts,
         chunks);
     libff::leave_block("Compute evaluation to B-query", false);
 
     libff::enter_block("Compute evaluation to H-query", false);
-    libff::G1<ppT> evaluation_Ht = libff::multi_exp<libff::G1<ppT>,
-                                                    libff::Fr<ppT>,
-                                                    libff::multi_exp_method_BDLO12>(
+    const std::vector<libff::G1<ppT> > evaluation_Ht = multi_exp_batch<libff::G1<ppT>, libff::Fr<ppT> >(
         pk.H_query.begin(),
-        pk.H_query.begin() + (qap_wit.degree() - 1),
-        qap_wit.coefficients_for_H.begin(),
-        qap_wit.coefficients_for_H.begin() + (qap_wit.degree() - 1),
+        pk.H_query.begin() + (batch_size > 0 ? degree - 1 : 0),
+        H_scalar_starts,
         chunks);
     libff::leave_block("Compute evaluation to H-query", false);
 
     libff::enter_block("Compute evaluation to L-query", false);
-    libff::G1<ppT> evaluation_Lt = libff::multi_exp_with_mixed_addition<libff::G1<ppT>,
-                                                                        libff::Fr<ppT>,
-                                                                        libff::multi_exp_method_BDLO12>(
+    const std::vector<libff::G1<ppT> > evaluation_Lt = multi_exp_batch<libff::G1<ppT>, libff::Fr<ppT> >(
         pk.L_query.begin(),
         pk.L_query.end(),
-        const_padded_assignment.begin() + qap_wit.num_inputs() + 1,
-        const_padded_assignment.begin() + qap_wit.num_variables() + 1,
+        L_scalar_starts,
         chunks);
     libff::leave_block("Compute evaluation to L-query", false);
 
-    /* A = alpha + sum_i(a_i*A_i(t)) + r*delta */
-    libff::G1<ppT> g1_A = pk.alpha_g1 + evaluation_At + r * pk.delta_g1;
-
-    /* B = beta + sum_i(a_i*B_i(t)) + s*delta */
-    libff::G1<ppT> g1_B = pk.beta_g1 + evaluation_Bt.h + s * pk.delta_g1;
-    libff::G2<ppT> g2_B = pk.beta_g2 + evaluation_Bt.g + s * pk.delta_g2;
-
-    /* C = sum_i(a_i*((beta*A_i(t) + alpha*B_i(t) + C_i(t)) + H(t)*Z(t))/delta) + A*s + r*b - r*s*delta */
-    libff::G1<ppT> g1_C = evaluation_Ht + evaluation_Lt + s *  g1_A + r * g1_B - (r * s) * pk.delta_g1;
+    std::vector<r1cs_gg_ppzksnark_zok_proof<ppT> > proofs;
+    proofs.reserve(batch_size);
 
-    libff::leave_block("Compute the proof");
+    for (size_t w = 0; w < batch_size; ++w)
+    {
+        proofs.emplace_back(r1cs_gg_ppzksnark_zok_assemble_proof<ppT>(pk, &context, evaluation_At[w], evaluation_Bt[w], evaluation_Ht[w], evaluation_Lt[w],
+                                                                      blinding[w].r, blinding[w].s));
+    }
 
-    libff::leave_block("Call to r1cs_gg_ppzksnark_zok_prover");
+    libff::leave_block("Compute the proofs");
 
-    r1cs_gg_ppzksnark_zok_proof<ppT> proof = r1cs_gg_ppzksnark_zok_proof<ppT>(std::move(g1_A), std::move(g2_B), std::move(g1_C));
-    proof.print_size();
+    libff::leave_block("Call to r1cs_gg_ppzksnark_zok_batch_prover");
 
-    return proof;
+    return proofs;
 }
 
 template <typename ppT>
@@ -519,8 +1409,7 @@ r1cs_gg_ppzksnark_zok_processed_verification_key<ppT> r1cs_gg_ppzksnark_zok_veri
     libff::enter_block("Call to r1cs_gg_ppzksnark_zok_verifier_process_vk");
 
     r1cs_gg_ppzksnark_zok_processed_verification_key<ppT> pvk;
-    pvk.vk_alpha_g1 = vk.alpha_g1;
-    pvk.vk_beta_g2 = vk.beta_g2;
+    pvk.vk_alpha_g1_beta_g2 = ppT::reduced_pairing(vk.alpha_g1, vk.beta_g2);
     pvk.vk_gamma_g2_precomp = ppT::precompute_G2(vk.gamma_g2);
     pvk.vk_delta_g2_precomp = ppT::precompute_G2(vk.delta_g2);
     pvk.gamma_ABC_g1 = vk.gamma_ABC_g1;
@@ -569,9 +1458,7 @@ bool r1cs_gg_ppzksnark_zok_online_verifier_weak_IC(const r1cs_gg_ppzksnark_zok_p
         proof_g_C_precomp, pvk.vk_delta_g2_precomp);
     const libff::GT<ppT> QAP = ppT::final_exponentiation(QAP1 * QAP2.unitary_inverse());
 
-    libff::GT<ppT> vk_alpha_g1_beta_g2 = ppT::reduced_pairing(pvk.vk_alpha_g1, pvk.vk_beta_g2);
-
-    if (QAP != vk_alpha_g1_beta_g2)
+    if (QAP != pvk.vk_alpha_g1_beta_g2)
     {
         if (!libff::inhibit_profiling_info)
         {
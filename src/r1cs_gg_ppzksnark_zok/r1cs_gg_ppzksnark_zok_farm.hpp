@@ -0,0 +1,140 @@
+/** @file
+ *****************************************************************************
+
+ Declaration of interfaces for a prover making many proofs on one host.
+
+ A proof uses every thread in its multi-exponentiations, but spends part of
+ its time in phases that do not scale with threads (the witness density,
+ the parts of the FFTs and of the assembly done by one thread), and small
+ circuits do not have enough bases to keep many threads busy. Running
+ several proofs at once, each with its own OpenMP parallel region using all
+ the threads, oversubscribes the cores instead.
+
+ The farm runs a queue of proofs in lanes: each lane makes one proof at a
+ time with its share of the threads, and lanes take the next proof of the
+ queue as they finish theirs, so long and short proofs balance out. The
+ number of lanes follows from the size of the circuit and the length of the
+ queue: a circuit gets about one thread per `min_constraints_per_thread`
+ constraints, and the threads left over by one proof go to another lane.
+ A short queue of large proofs thus runs one proof at a time with every
+ thread, and a long queue of small proofs one proof per thread.
+
+ All lanes share the proving key and its prover context; each has its own
+ workspace, kept from one queue to the next.
+
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef R1CS_GG_PPZKSNARK_ZOK_FARM_HPP_
+#define R1CS_GG_PPZKSNARK_ZOK_FARM_HPP_
+
+#include <memory>
+#include <vector>
+
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok.hpp"
+
+namespace libsnark {
+
+/**
+ * How a queue of proofs is spread over the threads: `lane_threads[i]`
+ * threads for each of the lane_threads.size() lanes.
+ */
+class r1cs_gg_ppzksnark_zok_farm_schedule {
+public:
+    std::vector<size_t> lane_threads;
+
+    /**
+     * Schedule for `queue_depth` proofs of circuits of `num_constraints`
+     * constraints on `num_threads` threads.
+     */
+    r1cs_gg_ppzksnark_zok_farm_schedule(const size_t num_constraints,
+                                        const size_t queue_depth,
+                                        const size_t num_threads,
+                                        const size_t min_constraints_per_thread);
+
+    size_t num_lanes() const { return lane_threads.size(); }
+
+    void print() const;
+};
+
+/**
+ * Throughput of the proofs made by a farm.
+ */
+class r1cs_gg_ppzksnark_zok_farm_metrics {
+public:
+    size_t num_queues;
+    size_t num_proofs;
+    long long total_nsec;
+
+    /* Of the last queue */
+    size_t last_num_proofs;
+    size_t last_num_lanes;
+    long long last_nsec;
+
+    r1cs_gg_ppzksnark_zok_farm_metrics() :
+        num_queues(0), num_proofs(0), total_nsec(0),
+        last_num_proofs(0), last_num_lanes(0), last_nsec(0)
+    {};
+
+    double proofs_per_second() const
+    {
+        return total_nsec > 0 ? num_proofs * 1e9 / total_nsec : 0;
+    }
+
+    double last_proofs_per_second() const
+    {
+        return last_nsec > 0 ? last_num_proofs * 1e9 / last_nsec : 0;
+    }
+
+    void print() const;
+};
+
+/**
+ * A prover for queues of proofs against one proving key, see above.
+ *
+ * The key must outlive the farm. A farm proves one queue at a time.
+ */
+template<typename ppT>
+class r1cs_gg_ppzksnark_zok_prover_farm {
+public:
+    const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk;
+    const r1cs_gg_ppzksnark_zok_prover_context<ppT> context;
+    const r1cs_gg_ppzksnark_zok_prover_config config;
+
+    /* About 2^14 constraints keep a thread busy in the multi-exponentiations */
+    size_t min_constraints_per_thread;
+
+    r1cs_gg_ppzksnark_zok_farm_metrics metrics;
+
+    explicit r1cs_gg_ppzksnark_zok_prover_farm(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk,
+                                               const r1cs_gg_ppzksnark_zok_prover_config &config = r1cs_gg_ppzksnark_zok_prover_config());
+
+    /* Schedule of a queue of `queue_depth` proofs on the threads of OpenMP */
+    r1cs_gg_ppzksnark_zok_farm_schedule schedule(const size_t queue_depth) const;
+
+    /**
+     * Produces one proof for every (primary_inputs[i], auxiliary_inputs[i])
+     * pair, exactly as r1cs_gg_ppzksnark_zok_prover would.
+     */
+    std::vector<r1cs_gg_ppzksnark_zok_proof<ppT> > prove(const std::vector<r1cs_gg_ppzksnark_zok_primary_input<ppT> > &primary_inputs,
+                                                         const std::vector<r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> > &auxiliary_inputs);
+
+    /**
+     * As above, with blinding[i] for the i-th proof.
+     */
+    std::vector<r1cs_gg_ppzksnark_zok_proof<ppT> > prove(const std::vector<r1cs_gg_ppzksnark_zok_primary_input<ppT> > &primary_inputs,
+                                                         const std::vector<r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> > &auxiliary_inputs,
+                                                         const std::vector<r1cs_gg_ppzksnark_zok_blinding_factors<ppT> > &blinding);
+
+private:
+    std::vector<std::unique_ptr<r1cs_gg_ppzksnark_zok_prover_workspace<ppT> > > workspaces;
+};
+
+} // libsnark
+
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_farm.tcc"
+
+#endif // R1CS_GG_PPZKSNARK_ZOK_FARM_HPP_
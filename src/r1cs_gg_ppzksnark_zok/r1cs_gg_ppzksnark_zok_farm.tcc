@@ -0,0 +1,196 @@
+/** @file
+ *****************************************************************************
+
+ Implementation of interfaces for a prover making many proofs on one host.
+
+ See r1cs_gg_ppzksnark_zok_farm.hpp .
+
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef R1CS_GG_PPZKSNARK_ZOK_FARM_TCC_
+#define R1CS_GG_PPZKSNARK_ZOK_FARM_TCC_
+
+#include <algorithm>
+#include <cassert>
+
+#include <libff/common/profiling.hpp>
+
+#ifdef MULTICORE
+#include <omp.h>
+#endif
+
+namespace libsnark {
+
+inline r1cs_gg_ppzksnark_zok_farm_schedule::r1cs_gg_ppzksnark_zok_farm_schedule(const size_t num_constraints,
+                                                                              const size_t queue_depth,
+                                                                              const size_t num_threads,
+                                                                              const size_t min_constraints_per_thread)
+{
+    if (queue_depth == 0)
+    {
+        return;
+    }
+
+    const size_t threads = std::max<size_t>(num_threads, 1);
+    const size_t per_thread = std::max<size_t>(min_constraints_per_thread, 1);
+
+    /* The threads one proof keeps busy, and as many lanes as fit beside it */
+    const size_t proof_threads = std::min(std::max<size_t>((num_constraints + per_thread - 1) / per_thread, 1), threads);
+    const size_t num_lanes = std::min(queue_depth, std::max<size_t>(threads / proof_threads, 1));
+
+    /* Threads left over when the queue is short go to the lanes there are */
+    lane_threads.assign(num_lanes, threads / num_lanes);
+    for (size_t i = 0; i < threads % num_lanes; ++i)
+    {
+        ++lane_threads[i];
+    }
+}
+
+inline void r1cs_gg_ppzksnark_zok_farm_schedule::print() const
+{
+    if (libff::inhibit_profiling_info)
+    {
+        return;
+    }
+
+    libff::print_indent(); printf("* Prover farm lanes: %zu\n", num_lanes());
+    libff::print_indent(); printf("* Prover farm threads per lane: %zu\n", num_lanes() > 0 ? lane_threads[0] : 0);
+}
+
+inline void r1cs_gg_ppzksnark_zok_farm_metrics::print() const
+{
+    if (libff::inhibit_profiling_info)
+    {
+        return;
+    }
+
+    libff::print_indent(); printf("* Proofs: %zu in %zu queues, %.4fs, %.3f proofs/s\n",
+                                  num_proofs, num_queues, total_nsec * 1e-9, proofs_per_second());
+    libff::print_indent(); printf("* Last queue: %zu proofs in %zu lanes, %.4fs, %.3f proofs/s\n",
+                                  last_num_proofs, last_num_lanes, last_nsec * 1e-9, last_proofs_per_second());
+}
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_prover_farm<ppT>::r1cs_gg_ppzksnark_zok_prover_farm(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk,
+                                                                         const r1cs_gg_ppzksnark_zok_prover_config &config) :
+    pk(pk),
+    context(pk),
+    config(config),
+    min_constraints_per_thread(1ul << 14)
+{
+}
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_farm_schedule r1cs_gg_ppzksnark_zok_prover_farm<ppT>::schedule(const size_t queue_depth) const
+{
+#ifdef MULTICORE
+    const size_t num_threads = omp_get_max_threads(); // to override, set OMP_NUM_THREADS env var or call omp_set_num_threads()
+#else
+    const size_t num_threads = 1;
+#endif
+
+    return r1cs_gg_ppzksnark_zok_farm_schedule(pk.constraint_matrices.num_constraints(), queue_depth, num_threads, min_constraints_per_thread);
+}
+
+template<typename ppT>
+std::vector<r1cs_gg_ppzksnark_zok_proof<ppT> > r1cs_gg_ppzksnark_zok_prover_farm<ppT>::prove(const std::vector<r1cs_gg_ppzksnark_zok_primary_input<ppT> > &primary_inputs,
+                                                                                            const std::vector<r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> > &auxiliary_inputs)
+{
+    /* Drawn here, the generator is not thread-safe */
+    std::vector<r1cs_gg_ppzksnark_zok_blinding_factors<ppT> > blinding;
+    blinding.reserve(primary_inputs.size());
+    for (size_t i = 0; i < primary_inputs.size(); ++i)
+    {
+        blinding.emplace_back(r1cs_gg_ppzksnark_zok_blinding_factors<ppT>::random());
+    }
+
+    return prove(primary_inputs, auxiliary_inputs, blinding);
+}
+
+template<typename ppT>
+std::vector<r1cs_gg_ppzksnark_zok_proof<ppT> > r1cs_gg_ppzksnark_zok_prover_farm<ppT>::prove(const std::vector<r1cs_gg_ppzksnark_zok_primary_input<ppT> > &primary_inputs,
+                                                                                            const std::vector<r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> > &auxiliary_inputs,
+                                                                                            const std::vector<r1cs_gg_ppzksnark_zok_blinding_factors<ppT> > &blinding)
+{
+    libff::enter_block("Call to r1cs_gg_ppzksnark_zok_prover_farm::prove");
+
+    const size_t queue_depth = primary_inputs.size();
+    assert(auxiliary_inputs.size() == queue_depth);
+    assert(blinding.size() == queue_depth);
+
+    const r1cs_gg_ppzksnark_zok_farm_schedule queue_schedule = schedule(queue_depth);
+    const size_t num_lanes = queue_schedule.num_lanes();
+    queue_schedule.print();
+
+    while (workspaces.size() < num_lanes)
+    {
+        workspaces.emplace_back(new r1cs_gg_ppzksnark_zok_prover_workspace<ppT>(context));
+    }
+
+    std::vector<r1cs_gg_ppzksnark_zok_proof<ppT> > proofs(queue_depth);
+    const long long start = libff::get_nsec_time();
+
+#ifdef MULTICORE
+    if (num_lanes > 1)
+    {
+        /* The profiling state is not thread-safe, and the blocks of
+           concurrent proofs would interleave anyway */
+        const bool inhibit_info = libff::inhibit_profiling_info;
+        const bool inhibit_counters = libff::inhibit_profiling_counters;
+        libff::inhibit_profiling_info = true;
+        libff::inhibit_profiling_counters = true;
+
+        /* Lanes, the tasks of each proof, and the multi-exponentiations
+           within those are nested parallel regions */
+        const int max_active_levels = omp_get_max_active_levels();
+        omp_set_max_active_levels(std::max(max_active_levels, 3));
+
+#pragma omp parallel num_threads(num_lanes)
+        {
+            const size_t lane = omp_get_thread_num();
+            omp_set_num_threads(queue_schedule.lane_threads[lane]);
+
+            /* Lanes take the next proof of the queue as they become free */
+#pragma omp for schedule(dynamic, 1)
+            for (size_t i = 0; i < queue_depth; ++i)
+            {
+                proofs[i] = r1cs_gg_ppzksnark_zok_prover<ppT>(pk, context, *workspaces[lane], primary_inputs[i], auxiliary_inputs[i], blinding[i], config);
+            }
+        }
+
+        omp_set_max_active_levels(max_active_levels);
+
+        libff::inhibit_profiling_info = inhibit_info;
+        libff::inhibit_profiling_counters = inhibit_counters;
+    }
+    else
+#endif
+    {
+        for (size_t i = 0; i < queue_depth; ++i)
+        {
+            proofs[i] = r1cs_gg_ppzksnark_zok_prover<ppT>(pk, context, *workspaces[0], primary_inputs[i], auxiliary_inputs[i], blinding[i], config);
+        }
+    }
+
+    const long long nsec = libff::get_nsec_time() - start;
+
+    metrics.num_queues += 1;
+    metrics.num_proofs += queue_depth;
+    metrics.total_nsec += nsec;
+    metrics.last_num_proofs = queue_depth;
+    metrics.last_num_lanes = num_lanes;
+    metrics.last_nsec = nsec;
+    metrics.print();
+
+    libff::leave_block("Call to r1cs_gg_ppzksnark_zok_prover_farm::prove");
+
+    return proofs;
+}
+
+} // libsnark
+
+#endif // R1CS_GG_PPZKSNARK_ZOK_FARM_TCC_
@@ -0,0 +1,121 @@
+/** @file
+ *****************************************************************************
+
+ Declaration of interfaces for a prover updating its previous proof when
+ only a few variables of the witness change.
+
+ The evaluations of the A, B and L queries are linear in the assignment:
+ when variables x_i change to x_i', each evaluation changes by
+ sum_i (x_i' - x_i) * base_i over the changed variables only. The
+ incremental prover keeps the (unblinded) evaluations of the last witness
+ and updates them with multi-exponentiations over the changed variables,
+ so consecutive proofs whose witnesses differ in a few variables, such as
+ a few leaves of a Merkle tree, pay for those queries in proportion to the
+ change. H is not linear in the assignment and is computed in full, as are
+ the blinding terms, which are fresh for every proof.
+
+ The proofs are those of r1cs_gg_ppzksnark_zok_prover for the same witness
+ and blinding factors.
+
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef R1CS_GG_PPZKSNARK_ZOK_INCREMENTAL_HPP_
+#define R1CS_GG_PPZKSNARK_ZOK_INCREMENTAL_HPP_
+
+#include <utility>
+#include <vector>
+
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok.hpp"
+
+namespace libsnark {
+
+/**
+ * A prover keeping the witness of its last proof and the evaluations of the
+ * A, B and L queries on it, see above.
+ *
+ * The key must outlive the prover. A prover makes one proof at a time.
+ */
+template<typename ppT>
+class r1cs_gg_ppzksnark_zok_incremental_prover {
+public:
+    /* New values of variables, by their index in the constraint system:
+       1 to num_inputs for the primary inputs, then the auxiliary ones */
+    typedef std::vector<std::pair<size_t, libff::Fr<ppT> > > changes_type;
+
+    const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk;
+    const r1cs_gg_ppzksnark_zok_prover_context<ppT> context;
+    const r1cs_gg_ppzksnark_zok_prover_config config;
+
+    /* Variables changed by the last proof */
+    size_t last_num_changed;
+
+    /**
+     * Evaluates the A, B and L queries on the initial witness, which costs
+     * about as much as those queries do in a proof.
+     */
+    r1cs_gg_ppzksnark_zok_incremental_prover(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk,
+                                             const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                             const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                             const r1cs_gg_ppzksnark_zok_prover_config &config = r1cs_gg_ppzksnark_zok_prover_config());
+
+    /**
+     * Applies `changes` to the witness, in order, and proves it. Throws
+     * std::out_of_range, leaving the witness as it was, when a change is
+     * not of a variable of the constraint system.
+     */
+    r1cs_gg_ppzksnark_zok_proof<ppT> prove(const changes_type &changes);
+
+    /**
+     * As above, with the blinding factors of `blinding` instead of random
+     * ones.
+     */
+    r1cs_gg_ppzksnark_zok_proof<ppT> prove(const changes_type &changes,
+                                           const r1cs_gg_ppzksnark_zok_blinding_factors<ppT> &blinding);
+
+    /**
+     * Proves a whole new witness, the changed variables being found by
+     * comparing it with the last one.
+     */
+    r1cs_gg_ppzksnark_zok_proof<ppT> prove(const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                           const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input);
+
+    r1cs_gg_ppzksnark_zok_proof<ppT> prove(const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                           const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                           const r1cs_gg_ppzksnark_zok_blinding_factors<ppT> &blinding);
+
+    const r1cs_gg_ppzksnark_zok_primary_input<ppT>& primary_input() const { return primary; }
+    const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT>& auxiliary_input() const { return auxiliary; }
+
+private:
+    r1cs_gg_ppzksnark_zok_prover_workspace<ppT> workspace;
+
+    r1cs_gg_ppzksnark_zok_primary_input<ppT> primary;
+    r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> auxiliary;
+
+    libff::G1<ppT> evaluation_At;
+    knowledge_commitment<libff::G2<ppT>, libff::G1<ppT> > evaluation_Bt;
+    libff::G1<ppT> evaluation_Lt;
+
+    libff::Fr<ppT>& variable(const size_t index);
+
+    /* Adds sum_j deltas[j] * base(changed[j]) to the evaluations, for the
+       sorted indices `changed`, and evaluates the H-query of the witness in
+       `evaluation_Ht` when it is not null */
+    void evaluate(const std::vector<size_t> &changed,
+                  const libff::Fr_vector<ppT> &deltas,
+                  libff::G1<ppT> *evaluation_Ht);
+
+    r1cs_gg_ppzksnark_zok_proof<ppT> prove_changed(const std::vector<size_t> &changed,
+                                                   const libff::Fr_vector<ppT> &deltas,
+                                                   const r1cs_gg_ppzksnark_zok_blinding_factors<ppT> &blinding);
+};
+
+} // libsnark
+
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_incremental.tcc"
+
+#endif // R1CS_GG_PPZKSNARK_ZOK_INCREMENTAL_HPP_
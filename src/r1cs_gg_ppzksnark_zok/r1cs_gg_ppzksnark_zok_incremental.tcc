@@ -0,0 +1,322 @@
+/** @file
+ *****************************************************************************
+
+ Implementation of interfaces for a prover updating its previous proof when
+ only a few variables of the witness change.
+
+ See r1cs_gg_ppzksnark_zok_incremental.hpp .
+
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef R1CS_GG_PPZKSNARK_ZOK_INCREMENTAL_TCC_
+#define R1CS_GG_PPZKSNARK_ZOK_INCREMENTAL_TCC_
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+#include <libff/common/profiling.hpp>
+
+#ifdef MULTICORE
+#include <omp.h>
+#endif
+
+#include "r1cs_gg_ppzksnark_zok/scalar_multiplication/multiexp_density.hpp"
+#include "r1cs_gg_ppzksnark_zok/scalar_multiplication/pippenger.hpp"
+
+namespace libsnark {
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_incremental_prover<ppT>::r1cs_gg_ppzksnark_zok_incremental_prover(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk,
+                                                                                       const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                                                       const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                                                                       const r1cs_gg_ppzksnark_zok_prover_config &config) :
+    pk(pk),
+    context(pk),
+    config(config),
+    last_num_changed(0),
+    workspace(context),
+    primary(primary_input),
+    auxiliary(auxiliary_input),
+    evaluation_At(libff::G1<ppT>::zero()),
+    evaluation_Bt(libff::G2<ppT>::zero(), libff::G1<ppT>::zero()),
+    evaluation_Lt(libff::G1<ppT>::zero())
+{
+    libff::enter_block("Call to r1cs_gg_ppzksnark_zok_incremental_prover");
+
+    assert(primary.size() == pk.constraint_matrices.num_inputs());
+    assert(primary.size() + auxiliary.size() == pk.constraint_matrices.num_variables());
+
+    /* From the zero assignment, every non-zero variable changes, the
+       constant one included */
+    const r1cs_padded_assignment<libff::Fr<ppT> > const_padded_assignment(primary, auxiliary);
+
+    std::vector<size_t> changed;
+    libff::Fr_vector<ppT> deltas;
+    for (size_t i = 0; i < const_padded_assignment.size(); ++i)
+    {
+        if (!const_padded_assignment[i].is_zero())
+        {
+            changed.emplace_back(i);
+            deltas.emplace_back(const_padded_assignment[i]);
+        }
+    }
+
+    evaluate(changed, deltas, nullptr);
+
+    libff::leave_block("Call to r1cs_gg_ppzksnark_zok_incremental_prover");
+}
+
+template<typename ppT>
+libff::Fr<ppT>& r1cs_gg_ppzksnark_zok_incremental_prover<ppT>::variable(const size_t index)
+{
+    return (index <= primary.size()) ? primary[index - 1] : auxiliary[index - 1 - primary.size()];
+}
+
+template<typename ppT>
+void r1cs_gg_ppzksnark_zok_incremental_prover<ppT>::evaluate(const std::vector<size_t> &changed,
+                                                              const libff::Fr_vector<ppT> &deltas,
+                                                              libff::G1<ppT> *evaluation_Ht)
+{
+#ifdef MULTICORE
+    const size_t chunks = omp_get_max_threads(); // to override, set OMP_NUM_THREADS env var or call omp_set_num_threads()
+#else
+    const size_t chunks = 1;
+#endif
+
+    const size_t num_inputs = pk.constraint_matrices.num_inputs();
+    const size_t num_bits = libff::Fr<ppT>::size_in_bits();
+    const size_t num_changed = changed.size();
+
+    libff::enter_block("Compute change density", false);
+    const scalar_density<libff::Fr<ppT> > density(deltas.begin(), deltas.end());
+    density.print();
+
+    /* Every variable has a base in A */
+    const multi_exp_density_plan<libff::Fr<ppT> > A_plan(density, deltas.begin(), num_changed, multi_exp_offset_index(0),
+                                                         config.A_query_method == r1cs_gg_ppzksnark_zok_multi_exp_pippenger);
+
+    /* Only the auxiliary variables, which come last, have one in L */
+    const size_t L_first = std::lower_bound(changed.begin(), changed.end(), num_inputs + 1) - changed.begin();
+    std::vector<size_t> L_positions(changed.begin() + L_first, changed.end());
+    for (size_t &position : L_positions)
+    {
+        position -= num_inputs + 1;
+    }
+    const multi_exp_density_plan<libff::Fr<ppT> > L_plan(density, deltas.begin(), L_positions.size(), multi_exp_offset_index(L_first),
+                                                         config.L_query_method == r1cs_gg_ppzksnark_zok_multi_exp_pippenger);
+
+    /* B_query only holds the variables with a non-zero B polynomial */
+    std::vector<size_t> B_positions;
+    std::vector<size_t> B_changes;
+    for (size_t j = 0; j < num_changed; ++j)
+    {
+        const auto it = std::lower_bound(pk.B_query.indices.begin(), pk.B_query.indices.end(), changed[j]);
+        if (it != pk.B_query.indices.end() && *it == changed[j])
+        {
+            B_positions.emplace_back(it - pk.B_query.indices.begin());
+            B_changes.emplace_back(j);
+        }
+    }
+    const multi_exp_density_plan<libff::Fr<ppT> > B_plan(density, deltas.begin(), B_positions.size(), multi_exp_sparse_index(B_changes),
+                                                         config.B_query_method == r1cs_gg_ppzksnark_zok_multi_exp_pippenger);
+
+    A_plan.print("A");
+    B_plan.print("B");
+    L_plan.print("L");
+    libff::leave_block("Compute change density", false);
+
+    const pippenger_vector_accessor<libff::G1<ppT> > A_query(pk.A_query.begin());
+    const pippenger_kc_g_accessor<libff::G2<ppT>, libff::G1<ppT> > B_query_g(pk.B_query.values, 0);
+    const pippenger_kc_h_accessor<libff::G2<ppT>, libff::G1<ppT> > B_query_h(pk.B_query.values, 0);
+    const pippenger_vector_accessor<libff::G1<ppT> > L_query(pk.L_query.begin());
+
+    const r1cs_padded_assignment<libff::Fr<ppT> > const_padded_assignment(primary, auxiliary);
+
+    libff::G1<ppT> change_At;
+    libff::G2<ppT> change_Bt_g;
+    libff::G1<ppT> change_Bt_h;
+    libff::G1<ppT> change_Lt;
+
+    std::vector<std::string> task_names;
+    std::vector<double> task_costs;
+    std::vector<std::function<void(const size_t)> > tasks;
+
+    if (evaluation_Ht != nullptr)
+    {
+        task_names.emplace_back("Compute the polynomial H and evaluation to H-query");
+        task_costs.emplace_back(r1cs_gg_ppzksnark_zok_multi_exp_cost(0, pk.H_query.size(), num_bits) +
+                                r1cs_gg_ppzksnark_zok_fft_cost(pk.H_query.size()));
+        tasks.emplace_back([&](const size_t task_chunks) {
+            *evaluation_Ht = r1cs_gg_ppzksnark_zok_evaluate_H_query<ppT>(pk, &context, workspace, nullptr, const_padded_assignment, config, task_chunks);
+        });
+    }
+
+    task_names.emplace_back("Update evaluation to A-query");
+    task_costs.emplace_back(r1cs_gg_ppzksnark_zok_multi_exp_cost(A_plan.one_bases.size(), A_plan.dense_bases.size(), num_bits));
+    tasks.emplace_back([&](const size_t task_chunks) {
+        change_At = multi_exp_with_density<libff::G1<ppT> >(
+            A_plan,
+            multi_exp_indexed_accessor<pippenger_vector_accessor<libff::G1<ppT> > >(A_query, changed),
+            task_chunks);
+    });
+
+    const double B_cost = r1cs_gg_ppzksnark_zok_multi_exp_cost(B_plan.one_bases.size(), B_plan.dense_bases.size(), num_bits);
+
+    task_names.emplace_back("Update evaluation to B-query (G2)");
+    task_costs.emplace_back(3 * B_cost);
+    tasks.emplace_back([&](const size_t task_chunks) {
+        change_Bt_g = multi_exp_with_density<libff::G2<ppT> >(
+            B_plan,
+            multi_exp_indexed_accessor<pippenger_kc_g_accessor<libff::G2<ppT>, libff::G1<ppT> > >(B_query_g, B_positions),
+            task_chunks);
+    });
+
+    task_names.emplace_back("Update evaluation to B-query (G1)");
+    task_costs.emplace_back(B_cost);
+    tasks.emplace_back([&](const size_t task_chunks) {
+        change_Bt_h = multi_exp_with_density<libff::G1<ppT> >(
+            B_plan,
+            multi_exp_indexed_accessor<pippenger_kc_h_accessor<libff::G2<ppT>, libff::G1<ppT> > >(B_query_h, B_positions),
+            task_chunks);
+    });
+
+    task_names.emplace_back("Update evaluation to L-query");
+    task_costs.emplace_back(r1cs_gg_ppzksnark_zok_multi_exp_cost(L_plan.one_bases.size(), L_plan.dense_bases.size(), num_bits));
+    tasks.emplace_back([&](const size_t task_chunks) {
+        change_Lt = multi_exp_with_density<libff::G1<ppT> >(
+            L_plan,
+            multi_exp_indexed_accessor<pippenger_vector_accessor<libff::G1<ppT> > >(L_query, L_positions),
+            task_chunks);
+    });
+
+    r1cs_gg_ppzksnark_zok_run_tasks(task_names, task_costs, tasks, config.overlap_tasks ? chunks : 1, chunks);
+
+    evaluation_At = evaluation_At + change_At;
+    evaluation_Bt = evaluation_Bt + knowledge_commitment<libff::G2<ppT>, libff::G1<ppT> >(change_Bt_g, change_Bt_h);
+    evaluation_Lt = evaluation_Lt + change_Lt;
+}
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_incremental_prover<ppT>::prove_changed(const std::vector<size_t> &changed,
+                                                                                             const libff::Fr_vector<ppT> &deltas,
+                                                                                             const r1cs_gg_ppzksnark_zok_blinding_factors<ppT> &blinding)
+{
+    libff::enter_block("Call to r1cs_gg_ppzksnark_zok_incremental_prover::prove");
+
+#ifdef DEBUG
+    assert(pk.constraint_matrices.is_satisfied(primary, auxiliary));
+#endif
+
+    if (!libff::inhibit_profiling_info)
+    {
+        libff::print_indent(); printf("* Changed variables: %zu\n", changed.size());
+    }
+
+    libff::enter_block("Compute the proof");
+
+    libff::G1<ppT> evaluation_Ht;
+    evaluate(changed, deltas, &evaluation_Ht);
+
+    r1cs_gg_ppzksnark_zok_proof<ppT> proof = r1cs_gg_ppzksnark_zok_assemble_proof<ppT>(pk, &context, evaluation_At, evaluation_Bt, evaluation_Ht, evaluation_Lt, blinding.r, blinding.s);
+
+    libff::leave_block("Compute the proof");
+
+    last_num_changed = changed.size();
+
+    libff::leave_block("Call to r1cs_gg_ppzksnark_zok_incremental_prover::prove");
+
+    proof.print_size();
+
+    return proof;
+}
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_incremental_prover<ppT>::prove(const changes_type &changes)
+{
+    return prove(changes, r1cs_gg_ppzksnark_zok_blinding_factors<ppT>::random());
+}
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_incremental_prover<ppT>::prove(const changes_type &changes,
+                                                                                     const r1cs_gg_ppzksnark_zok_blinding_factors<ppT> &blinding)
+{
+    const size_t num_variables = primary.size() + auxiliary.size();
+    for (const auto &change : changes)
+    {
+        if (change.first == 0 || change.first > num_variables)
+        {
+            throw std::out_of_range("r1cs_gg_ppzksnark_zok_incremental_prover: no variable " + std::to_string(change.first));
+        }
+    }
+
+    /* The last change of a variable is its new value */
+    changes_type sorted_changes(changes);
+    std::stable_sort(sorted_changes.begin(), sorted_changes.end(),
+                     [](const typename changes_type::value_type &a, const typename changes_type::value_type &b) {
+                         return a.first < b.first;
+                     });
+
+    std::vector<size_t> changed;
+    libff::Fr_vector<ppT> deltas;
+    for (size_t j = 0; j < sorted_changes.size(); ++j)
+    {
+        if (j + 1 < sorted_changes.size() && sorted_changes[j + 1].first == sorted_changes[j].first)
+        {
+            continue;
+        }
+
+        libff::Fr<ppT> &value = variable(sorted_changes[j].first);
+        const libff::Fr<ppT> delta = sorted_changes[j].second - value;
+        if (!delta.is_zero())
+        {
+            changed.emplace_back(sorted_changes[j].first);
+            deltas.emplace_back(delta);
+            value = sorted_changes[j].second;
+        }
+    }
+
+    return prove_changed(changed, deltas, blinding);
+}
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_incremental_prover<ppT>::prove(const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                                                     const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input)
+{
+    return prove(primary_input, auxiliary_input, r1cs_gg_ppzksnark_zok_blinding_factors<ppT>::random());
+}
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_incremental_prover<ppT>::prove(const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                                                     const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                                                                     const r1cs_gg_ppzksnark_zok_blinding_factors<ppT> &blinding)
+{
+    assert(primary_input.size() == primary.size());
+    assert(auxiliary_input.size() == auxiliary.size());
+
+    std::vector<size_t> changed;
+    libff::Fr_vector<ppT> deltas;
+    for (size_t i = 1; i <= primary.size() + auxiliary.size(); ++i)
+    {
+        libff::Fr<ppT> &value = variable(i);
+        const libff::Fr<ppT> &new_value = (i <= primary.size()) ? primary_input[i - 1] : auxiliary_input[i - 1 - primary.size()];
+        if (new_value != value)
+        {
+            changed.emplace_back(i);
+            deltas.emplace_back(new_value - value);
+            value = new_value;
+        }
+    }
+
+    return prove_changed(changed, deltas, blinding);
+}
+
+} // libsnark
+
+#endif // R1CS_GG_PPZKSNARK_ZOK_INCREMENTAL_TCC_
@@ -0,0 +1,230 @@
+/** @file
+ *****************************************************************************
+
+ Declaration of interfaces for a memory-mapped proving key.
+
+ The serialized proving key (operator<<) is text, and has to be parsed into
+ a new copy by every process using it. The mapped format instead stores the
+ points of the A, B, H and L queries as the in-memory objects of the group
+ types, in special (affine, Montgomery) form, each query in its own section
+ aligned to a page. A prover maps the file read-only and reads the queries
+ in place: opening a key only costs the few pages of its header and small
+ points, and every process proving with the same file shares one copy of it
+ in the page cache.
+
+ The layout of the group types depends on the curve, the limb size and the
+ build, so a mapped key is only usable by a build with the same layout; the
+ header records the size of each type and the encoding of the generators,
+ and opening a key written by another layout fails.
+
+ The constraint matrices, needed to compute H, are kept in their serialized
+ form and are parsed when the key is opened, as is the density of the
+ A-query.
+
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef R1CS_GG_PPZKSNARK_ZOK_MAPPED_HPP_
+#define R1CS_GG_PPZKSNARK_ZOK_MAPPED_HPP_
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok.hpp"
+
+namespace libsnark {
+
+/**
+ * Position of a section in a mapped proving key: `count` elements starting
+ * `offset` bytes from the start of the file.
+ */
+class r1cs_gg_ppzksnark_zok_mapped_section {
+public:
+    uint64_t offset;
+    uint64_t count;
+};
+
+/**
+ * Header at the start of a mapped proving key.
+ */
+class r1cs_gg_ppzksnark_zok_mapped_header {
+public:
+    static const uint64_t magic_value = 0x31504b4d4b4f5a00ull; // "\0ZOKMKP1"
+    static const uint64_t current_version = 2;
+    static const uint64_t section_alignment = 4096;
+
+    uint64_t magic;
+    uint64_t version;
+    uint64_t file_size;
+
+    /* sizeof of the stored types, to reject keys of another layout */
+    uint64_t index_bytes;
+    uint64_t G1_bytes;
+    uint64_t G2_bytes;
+    uint64_t B_element_bytes;
+
+    uint64_t num_inputs;
+    uint64_t num_variables;
+
+    /* (alpha, beta, delta, one) in G1 and (beta, delta, one) in G2 */
+    r1cs_gg_ppzksnark_zok_mapped_section G1_points;
+    r1cs_gg_ppzksnark_zok_mapped_section G2_points;
+
+    /* The density of A packed in 64-bit words, see r1cs_gg_ppzksnark_zok_pack_density */
+    r1cs_gg_ppzksnark_zok_mapped_section A_density;
+    r1cs_gg_ppzksnark_zok_mapped_section A_query;
+    r1cs_gg_ppzksnark_zok_mapped_section B_indices;
+    r1cs_gg_ppzksnark_zok_mapped_section B_query;
+    r1cs_gg_ppzksnark_zok_mapped_section H_query;
+    r1cs_gg_ppzksnark_zok_mapped_section L_query;
+
+    /* Serialized constraint matrices, `count` is in bytes */
+    r1cs_gg_ppzksnark_zok_mapped_section constraint_matrices;
+};
+
+/**
+ * Writes `pk` to `out` in the mapped format.
+ */
+template<typename ppT>
+void r1cs_gg_ppzksnark_zok_write_mapped_proving_key(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk,
+                                                    std::ostream &out);
+
+/**
+ * A whole file mapped read-only, unmapped when the object is destroyed.
+ */
+class r1cs_gg_ppzksnark_zok_file_mapping {
+public:
+    r1cs_gg_ppzksnark_zok_file_mapping() : address(nullptr), length(0) {};
+
+    r1cs_gg_ppzksnark_zok_file_mapping(const r1cs_gg_ppzksnark_zok_file_mapping &other) = delete;
+    r1cs_gg_ppzksnark_zok_file_mapping& operator=(const r1cs_gg_ppzksnark_zok_file_mapping &other) = delete;
+
+    ~r1cs_gg_ppzksnark_zok_file_mapping();
+
+    /**
+     * Maps `path` in place of the current mapping, throwing
+     * std::runtime_error when the file cannot be mapped and
+     * std::invalid_argument when it is smaller than `min_size` bytes.
+     */
+    void map(const std::string &path, const size_t min_size);
+
+    const void* data() const { return address; }
+    size_t size() const { return length; }
+
+private:
+    void *address;
+    size_t length;
+};
+
+/**
+ * A proving key mapped read-only from a file written by
+ * r1cs_gg_ppzksnark_zok_write_mapped_proving_key.
+ *
+ * The query pointers stay valid for the lifetime of the object. `pk` holds
+ * the points and constraint matrices used outside the queries, and the
+ * density of A; its query vectors are empty. `context` is created for it
+ * when the key is opened.
+ *
+ * The prover does not modify a mapped key, so concurrent proofs may share
+ * it, each with its own workspace.
+ */
+template<typename ppT>
+class r1cs_gg_ppzksnark_zok_mapped_proving_key {
+private:
+    /* Declared first, the mapping is made before pk and context are set,
+       and released if setting them throws */
+    r1cs_gg_ppzksnark_zok_file_mapping mapping;
+
+public:
+    typedef knowledge_commitment<libff::G2<ppT>, libff::G1<ppT> > B_element_type;
+
+    r1cs_gg_ppzksnark_zok_proving_key<ppT> pk;
+    r1cs_gg_ppzksnark_zok_prover_context<ppT> context;
+
+    size_t num_inputs;
+    size_t num_variables;
+
+    const libff::G1<ppT> *A_query;
+    size_t A_query_size;
+    const size_t *B_indices;
+    const B_element_type *B_query;
+    size_t B_query_size;
+    const libff::G1<ppT> *H_query;
+    size_t H_query_size;
+    const libff::G1<ppT> *L_query;
+    size_t L_query_size;
+
+    /**
+     * Maps the key at `path`, throwing std::runtime_error when the file
+     * cannot be mapped and std::invalid_argument when it is not a mapped
+     * key of this layout, or its queries do not match its constraint system.
+     */
+    explicit r1cs_gg_ppzksnark_zok_mapped_proving_key(const std::string &path);
+
+    r1cs_gg_ppzksnark_zok_mapped_proving_key(const r1cs_gg_ppzksnark_zok_mapped_proving_key<ppT> &other) = delete;
+    r1cs_gg_ppzksnark_zok_mapped_proving_key<ppT>& operator=(const r1cs_gg_ppzksnark_zok_mapped_proving_key<ppT> &other) = delete;
+
+    size_t mapped_size_in_bytes() const
+    {
+        return mapping.size();
+    }
+
+    void print_size() const
+    {
+        libff::print_indent(); printf("* Mapped PK size in bytes: %zu\n", this->mapped_size_in_bytes());
+        libff::print_indent(); printf("* Mapped PK queries (A, B, H, L): %zu, %zu, %zu, %zu\n",
+                                      A_query_size, B_query_size, H_query_size, L_query_size);
+    }
+
+private:
+    /* Maps `path` and checks its header, returns the key without its
+       queries */
+    r1cs_gg_ppzksnark_zok_proving_key<ppT> map_file(const std::string &path);
+
+    const r1cs_gg_ppzksnark_zok_mapped_header& header() const
+    {
+        return *static_cast<const r1cs_gg_ppzksnark_zok_mapped_header*>(mapping.data());
+    }
+
+    template<typename T>
+    const T* section(const r1cs_gg_ppzksnark_zok_mapped_section &s) const
+    {
+        return reinterpret_cast<const T*>(static_cast<const char*>(mapping.data()) + s.offset);
+    }
+};
+
+/**
+ * A prover algorithm for the R1CS GG-ppzkSNARK reading the queries of a
+ * mapped proving key in place, in the buffers of `workspace`.
+ *
+ * Every query is evaluated with Pippenger's method, whatever the methods of
+ * `config`: libff's BDLO12 method takes its bases from a vector, and would
+ * copy the queries out of the shared mapping on every proof.
+ */
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(const r1cs_gg_ppzksnark_zok_mapped_proving_key<ppT> &mpk,
+                                                      r1cs_gg_ppzksnark_zok_prover_workspace<ppT> &workspace,
+                                                      const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                      const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                                      const r1cs_gg_ppzksnark_zok_prover_config &config = r1cs_gg_ppzksnark_zok_prover_config());
+
+/**
+ * As above, with the blinding factors of `blinding` instead of random ones.
+ */
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(const r1cs_gg_ppzksnark_zok_mapped_proving_key<ppT> &mpk,
+                                                      r1cs_gg_ppzksnark_zok_prover_workspace<ppT> &workspace,
+                                                      const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                      const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                                      const r1cs_gg_ppzksnark_zok_blinding_factors<ppT> &blinding,
+                                                      const r1cs_gg_ppzksnark_zok_prover_config &config = r1cs_gg_ppzksnark_zok_prover_config());
+
+} // libsnark
+
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_mapped.tcc"
+
+#endif // R1CS_GG_PPZKSNARK_ZOK_MAPPED_HPP_
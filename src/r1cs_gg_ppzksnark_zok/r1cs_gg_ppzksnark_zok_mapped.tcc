@@ -0,0 +1,546 @@
+/** @file
+ *****************************************************************************
+
+ Implementation of interfaces for a memory-mapped proving key.
+
+ See r1cs_gg_ppzksnark_zok_mapped.hpp .
+
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef R1CS_GG_PPZKSNARK_ZOK_MAPPED_TCC_
+#define R1CS_GG_PPZKSNARK_ZOK_MAPPED_TCC_
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <libff/algebra/scalar_multiplication/multiexp.hpp>
+#include <libff/common/profiling.hpp>
+
+#ifdef MULTICORE
+#include <omp.h>
+#endif
+
+#include "r1cs_gg_ppzksnark_zok/scalar_multiplication/multiexp_density.hpp"
+#include "r1cs_gg_ppzksnark_zok/scalar_multiplication/pippenger.hpp"
+
+namespace libsnark {
+
+/**
+ * Places a section of `count` elements of `element_bytes` at the next
+ * aligned offset after `position`, and moves `position` past it.
+ */
+inline r1cs_gg_ppzksnark_zok_mapped_section r1cs_gg_ppzksnark_zok_place_section(uint64_t &position,
+                                                                               const size_t count,
+                                                                               const size_t element_bytes)
+{
+    const uint64_t alignment = r1cs_gg_ppzksnark_zok_mapped_header::section_alignment;
+
+    r1cs_gg_ppzksnark_zok_mapped_section section;
+    section.offset = (position + alignment - 1) / alignment * alignment;
+    section.count = count;
+    position = section.offset + count * element_bytes;
+
+    return section;
+}
+
+/**
+ * Writes zeros up to `offset`, which must not be before `position`.
+ */
+inline void r1cs_gg_ppzksnark_zok_pad_to(std::ostream &out, uint64_t &position, const uint64_t offset)
+{
+    assert(offset >= position);
+    static const char zeros[r1cs_gg_ppzksnark_zok_mapped_header::section_alignment] = {0};
+
+    while (position < offset)
+    {
+        const size_t length = std::min<uint64_t>(offset - position, sizeof(zeros));
+        out.write(zeros, length);
+        position += length;
+    }
+}
+
+template<typename T>
+void r1cs_gg_ppzksnark_zok_write_objects(std::ostream &out, uint64_t &position, const T *objects, const size_t count)
+{
+    out.write(reinterpret_cast<const char*>(objects), count * sizeof(T));
+    position += count * sizeof(T);
+}
+
+/**
+ * Writes the points of `query` in special form, a batch at a time, at
+ * `section`.
+ */
+template<typename T>
+void r1cs_gg_ppzksnark_zok_write_points(std::ostream &out,
+                                        uint64_t &position,
+                                        const r1cs_gg_ppzksnark_zok_mapped_section &section,
+                                        const std::vector<T> &query)
+{
+    const size_t batch_size = 1ul << 16;
+
+    r1cs_gg_ppzksnark_zok_pad_to(out, position, section.offset);
+
+    std::vector<T> batch;
+    for (size_t offset = 0; offset < query.size(); offset += batch_size)
+    {
+        batch.assign(query.begin() + offset, query.begin() + std::min(offset + batch_size, query.size()));
+        libff::batch_to_special<T>(batch);
+        r1cs_gg_ppzksnark_zok_write_objects(out, position, batch.data(), batch.size());
+    }
+}
+
+template<typename ppT>
+void r1cs_gg_ppzksnark_zok_write_mapped_proving_key(const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk,
+                                                    std::ostream &out)
+{
+    typedef knowledge_commitment<libff::G2<ppT>, libff::G1<ppT> > B_element_type;
+
+    libff::enter_block("Call to r1cs_gg_ppzksnark_zok_write_mapped_proving_key");
+
+    std::vector<libff::G1<ppT> > G1_points = { pk.alpha_g1, pk.beta_g1, pk.delta_g1, libff::G1<ppT>::one() };
+    std::vector<libff::G2<ppT> > G2_points = { pk.beta_g2, pk.delta_g2, libff::G2<ppT>::one() };
+
+    std::stringstream constraint_matrices;
+    constraint_matrices << pk.constraint_matrices;
+    const std::string constraint_matrices_bytes = constraint_matrices.str();
+
+    const std::vector<uint64_t> A_density = r1cs_gg_ppzksnark_zok_pack_density(pk.A_density);
+
+    r1cs_gg_ppzksnark_zok_mapped_header header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = r1cs_gg_ppzksnark_zok_mapped_header::magic_value;
+    header.version = r1cs_gg_ppzksnark_zok_mapped_header::current_version;
+    header.index_bytes = sizeof(size_t);
+    header.G1_bytes = sizeof(libff::G1<ppT>);
+    header.G2_bytes = sizeof(libff::G2<ppT>);
+    header.B_element_bytes = sizeof(B_element_type);
+    header.num_inputs = pk.constraint_matrices.num_inputs();
+    header.num_variables = pk.constraint_matrices.num_variables();
+
+    uint64_t position = sizeof(header);
+    header.G1_points = r1cs_gg_ppzksnark_zok_place_section(position, G1_points.size(), sizeof(libff::G1<ppT>));
+    header.G2_points = r1cs_gg_ppzksnark_zok_place_section(position, G2_points.size(), sizeof(libff::G2<ppT>));
+    header.A_density = r1cs_gg_ppzksnark_zok_place_section(position, A_density.size(), sizeof(uint64_t));
+    header.A_query = r1cs_gg_ppzksnark_zok_place_section(position, pk.A_query.size(), sizeof(libff::G1<ppT>));
+    header.B_indices = r1cs_gg_ppzksnark_zok_place_section(position, pk.B_query.indices.size(), sizeof(size_t));
+    header.B_query = r1cs_gg_ppzksnark_zok_place_section(position, pk.B_query.values.size(), sizeof(B_element_type));
+    header.H_query = r1cs_gg_ppzksnark_zok_place_section(position, pk.H_query.size(), sizeof(libff::G1<ppT>));
+    header.L_query = r1cs_gg_ppzksnark_zok_place_section(position, pk.L_query.size(), sizeof(libff::G1<ppT>));
+    header.constraint_matrices = r1cs_gg_ppzksnark_zok_place_section(position, constraint_matrices_bytes.size(), 1);
+    header.file_size = position;
+
+    position = 0;
+    r1cs_gg_ppzksnark_zok_write_objects(out, position, &header, 1);
+
+    r1cs_gg_ppzksnark_zok_write_points(out, position, header.G1_points, G1_points);
+    r1cs_gg_ppzksnark_zok_write_points(out, position, header.G2_points, G2_points);
+
+    r1cs_gg_ppzksnark_zok_pad_to(out, position, header.A_density.offset);
+    r1cs_gg_ppzksnark_zok_write_objects(out, position, A_density.data(), A_density.size());
+
+    r1cs_gg_ppzksnark_zok_write_points(out, position, header.A_query, pk.A_query);
+
+    r1cs_gg_ppzksnark_zok_pad_to(out, position, header.B_indices.offset);
+    r1cs_gg_ppzksnark_zok_write_objects(out, position, pk.B_query.indices.data(), pk.B_query.indices.size());
+
+    /* Both halves of the B elements are converted in separate batches */
+    r1cs_gg_ppzksnark_zok_pad_to(out, position, header.B_query.offset);
+    const size_t batch_size = 1ul << 16;
+    std::vector<libff::G2<ppT> > B_g;
+    std::vector<libff::G1<ppT> > B_h;
+    std::vector<B_element_type> B_batch;
+    for (size_t offset = 0; offset < pk.B_query.values.size(); offset += batch_size)
+    {
+        const size_t length = std::min(batch_size, pk.B_query.values.size() - offset);
+        B_g.resize(length);
+        B_h.resize(length);
+        for (size_t i = 0; i < length; ++i)
+        {
+            B_g[i] = pk.B_query.values[offset + i].g;
+            B_h[i] = pk.B_query.values[offset + i].h;
+        }
+        libff::batch_to_special<libff::G2<ppT> >(B_g);
+        libff::batch_to_special<libff::G1<ppT> >(B_h);
+
+        B_batch.clear();
+        for (size_t i = 0; i < length; ++i)
+        {
+            B_batch.emplace_back(B_g[i], B_h[i]);
+        }
+        r1cs_gg_ppzksnark_zok_write_objects(out, position, B_batch.data(), B_batch.size());
+    }
+
+    r1cs_gg_ppzksnark_zok_write_points(out, position, header.H_query, pk.H_query);
+    r1cs_gg_ppzksnark_zok_write_points(out, position, header.L_query, pk.L_query);
+
+    r1cs_gg_ppzksnark_zok_pad_to(out, position, header.constraint_matrices.offset);
+    r1cs_gg_ppzksnark_zok_write_objects(out, position, constraint_matrices_bytes.data(), constraint_matrices_bytes.size());
+    assert(position == header.file_size);
+
+    libff::leave_block("Call to r1cs_gg_ppzksnark_zok_write_mapped_proving_key");
+}
+
+/**
+ * Whether `section` of `count` elements of `element_bytes` lies within a
+ * file of `file_size` bytes, at an offset aligned for the elements.
+ */
+inline bool r1cs_gg_ppzksnark_zok_section_fits(const r1cs_gg_ppzksnark_zok_mapped_section &section,
+                                               const size_t element_bytes,
+                                               const uint64_t file_size)
+{
+    return (section.offset % r1cs_gg_ppzksnark_zok_mapped_header::section_alignment == 0 &&
+            section.offset <= file_size &&
+            section.count <= (file_size - section.offset) / element_bytes);
+}
+
+inline r1cs_gg_ppzksnark_zok_file_mapping::~r1cs_gg_ppzksnark_zok_file_mapping()
+{
+    if (address != nullptr)
+    {
+        munmap(address, length);
+    }
+}
+
+inline void r1cs_gg_ppzksnark_zok_file_mapping::map(const std::string &path, const size_t min_size)
+{
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        const int error = errno;
+        close(fd);
+        throw std::runtime_error("cannot stat " + path + ": " + std::strerror(error));
+    }
+
+    const size_t size = st.st_size;
+    if (size < min_size)
+    {
+        close(fd);
+        throw std::invalid_argument(path + " is not a mapped proving key");
+    }
+
+    /* Shared and read-only, so every process mapping the file reads the
+       same pages of the page cache */
+    void *new_address = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    const int error = errno;
+    close(fd);
+    if (new_address == MAP_FAILED)
+    {
+        throw std::runtime_error("cannot map " + path + ": " + std::strerror(error));
+    }
+
+    if (address != nullptr)
+    {
+        munmap(address, length);
+    }
+    address = new_address;
+    length = size;
+}
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_mapped_proving_key<ppT>::r1cs_gg_ppzksnark_zok_mapped_proving_key(const std::string &path) :
+    mapping(),
+    pk(map_file(path)),
+    context(pk)
+{
+    const r1cs_gg_ppzksnark_zok_mapped_header &h = header();
+
+    num_inputs = h.num_inputs;
+    num_variables = h.num_variables;
+
+    A_query = section<libff::G1<ppT> >(h.A_query);
+    A_query_size = h.A_query.count;
+    B_indices = section<size_t>(h.B_indices);
+    B_query = section<B_element_type>(h.B_query);
+    B_query_size = h.B_query.count;
+    H_query = section<libff::G1<ppT> >(h.H_query);
+    H_query_size = h.H_query.count;
+    L_query = section<libff::G1<ppT> >(h.L_query);
+    L_query_size = h.L_query.count;
+
+    /* H has one coefficient fewer than the domain has points */
+    if (H_query_size != context.domain.m - 1)
+    {
+        throw std::invalid_argument(path + " has an H-query which does not match its evaluation domain");
+    }
+
+    this->print_size();
+    this->context.print_size();
+}
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_proving_key<ppT> r1cs_gg_ppzksnark_zok_mapped_proving_key<ppT>::map_file(const std::string &path)
+{
+    typedef r1cs_gg_ppzksnark_zok_mapped_header header_type;
+
+    libff::enter_block("Map proving key");
+
+    /* Released by the destructor of `mapping` if the key is rejected */
+    mapping.map(path, sizeof(header_type));
+    const size_t size = mapping.size();
+
+    typedef knowledge_commitment<libff::G2<ppT>, libff::G1<ppT> > B_element;
+    const header_type &h = header();
+
+    if (h.magic != header_type::magic_value || h.version != header_type::current_version)
+    {
+        throw std::invalid_argument(path + " is not a mapped proving key");
+    }
+
+    if (h.file_size != size)
+    {
+        throw std::invalid_argument(path + " is truncated");
+    }
+
+    if (h.index_bytes != sizeof(size_t) ||
+        h.G1_bytes != sizeof(libff::G1<ppT>) ||
+        h.G2_bytes != sizeof(libff::G2<ppT>) ||
+        h.B_element_bytes != sizeof(B_element))
+    {
+        throw std::invalid_argument(path + " was written for another layout of the group elements");
+    }
+
+    if (!r1cs_gg_ppzksnark_zok_section_fits(h.G1_points, sizeof(libff::G1<ppT>), size) || h.G1_points.count != 4 ||
+        !r1cs_gg_ppzksnark_zok_section_fits(h.G2_points, sizeof(libff::G2<ppT>), size) || h.G2_points.count != 3 ||
+        !r1cs_gg_ppzksnark_zok_section_fits(h.A_density, sizeof(uint64_t), size) ||
+        !r1cs_gg_ppzksnark_zok_section_fits(h.A_query, sizeof(libff::G1<ppT>), size) ||
+        !r1cs_gg_ppzksnark_zok_section_fits(h.B_indices, sizeof(size_t), size) ||
+        !r1cs_gg_ppzksnark_zok_section_fits(h.B_query, sizeof(B_element), size) ||
+        !r1cs_gg_ppzksnark_zok_section_fits(h.H_query, sizeof(libff::G1<ppT>), size) ||
+        !r1cs_gg_ppzksnark_zok_section_fits(h.L_query, sizeof(libff::G1<ppT>), size) ||
+        !r1cs_gg_ppzksnark_zok_section_fits(h.constraint_matrices, 1, size) ||
+        h.B_indices.count != h.B_query.count)
+    {
+        throw std::invalid_argument(path + " has a malformed section table");
+    }
+
+    const libff::G1<ppT> *G1_points = section<libff::G1<ppT> >(h.G1_points);
+    const libff::G2<ppT> *G2_points = section<libff::G2<ppT> >(h.G2_points);
+
+    /* Equal sizes do not rule out another representation of the
+       coordinates, such as another Montgomery radix */
+    if (!(G1_points[3] == libff::G1<ppT>::one()) || !(G2_points[2] == libff::G2<ppT>::one()))
+    {
+        throw std::invalid_argument(path + " was written for another encoding of the group elements");
+    }
+
+    r1cs_gg_ppzksnark_zok_proving_key<ppT> key;
+    key.alpha_g1 = G1_points[0];
+    key.beta_g1 = G1_points[1];
+    key.delta_g1 = G1_points[2];
+    key.beta_g2 = G2_points[0];
+    key.delta_g2 = G2_points[1];
+
+    std::stringstream constraint_matrices(std::string(section<char>(h.constraint_matrices), h.constraint_matrices.count));
+    constraint_matrices >> key.constraint_matrices;
+    if (!constraint_matrices)
+    {
+        throw std::invalid_argument(path + " has truncated constraint matrices");
+    }
+
+    try
+    {
+        key.constraint_matrices.validate();
+    }
+    catch (const std::invalid_argument &e)
+    {
+        throw std::invalid_argument(path + " has malformed constraint matrices: " + e.what());
+    }
+
+    if (key.constraint_matrices.num_inputs() != h.num_inputs ||
+        key.constraint_matrices.num_variables() != h.num_variables ||
+        h.A_query.count != h.num_variables + 1 ||
+        (h.A_density.count != 0 && h.A_density.count != (h.A_query.count + 63) / 64) ||
+        h.L_query.count != h.num_variables - h.num_inputs)
+    {
+        throw std::invalid_argument(path + " does not match its constraint system");
+    }
+
+    /* The prover searches the B indices and uses them to index the
+       assignment, they must be sorted and within the variables */
+    const size_t *B_indices = section<size_t>(h.B_indices);
+    for (size_t i = 0; i < h.B_indices.count; ++i)
+    {
+        if (B_indices[i] >= h.num_variables + 1 || (i > 0 && B_indices[i] <= B_indices[i - 1]))
+        {
+            throw std::invalid_argument(path + " has B-query indices which are not increasing variable indices");
+        }
+    }
+
+    if (h.A_density.count != 0)
+    {
+        key.A_density = r1cs_gg_ppzksnark_zok_unpack_density(section<uint64_t>(h.A_density), h.A_query.count);
+    }
+
+    libff::leave_block("Map proving key");
+
+    return key;
+}
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(const r1cs_gg_ppzksnark_zok_mapped_proving_key<ppT> &mpk,
+                                                      r1cs_gg_ppzksnark_zok_prover_workspace<ppT> &workspace,
+                                                      const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                      const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                                      const r1cs_gg_ppzksnark_zok_prover_config &config)
+{
+    return r1cs_gg_ppzksnark_zok_prover<ppT>(mpk, workspace, primary_input, auxiliary_input,
+                                             r1cs_gg_ppzksnark_zok_blinding_factors<ppT>::random(), config);
+}
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_prover(const r1cs_gg_ppzksnark_zok_mapped_proving_key<ppT> &mpk,
+                                                      r1cs_gg_ppzksnark_zok_prover_workspace<ppT> &workspace,
+                                                      const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                      const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                                      const r1cs_gg_ppzksnark_zok_blinding_factors<ppT> &blinding,
+                                                      const r1cs_gg_ppzksnark_zok_prover_config &config)
+{
+    libff::enter_block("Call to r1cs_gg_ppzksnark_zok_mapped_prover");
+
+    const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk = mpk.pk;
+
+#ifdef DEBUG
+    assert(pk.constraint_matrices.is_satisfied(primary_input, auxiliary_input));
+#endif
+
+    const size_t num_variables = mpk.num_variables;
+    const size_t num_inputs = mpk.num_inputs;
+    const size_t num_bits = libff::Fr<ppT>::size_in_bits();
+    assert(primary_input.size() + auxiliary_input.size() == num_variables);
+
+#ifdef MULTICORE
+    const size_t chunks = omp_get_max_threads(); // to override, set OMP_NUM_THREADS env var or call omp_set_num_threads()
+#else
+    const size_t chunks = 1;
+#endif
+
+    libff::enter_block("Compute witness density", false);
+    const r1cs_padded_assignment<libff::Fr<ppT> > const_padded_assignment(primary_input, auxiliary_input);
+
+    const scalar_density<libff::Fr<ppT> > density(const_padded_assignment.begin(), const_padded_assignment.begin() + num_variables + 1);
+    density.print();
+
+    /* libff's methods take the bases from a vector, which would copy them
+       out of the mapping on every proof: every query is evaluated with
+       Pippenger's method, reading the bases in place */
+    const multi_exp_density_plan<libff::Fr<ppT> > A_plan(density, const_padded_assignment.begin(), mpk.A_query_size, multi_exp_offset_index(0),
+                                                         true, &pk.A_density);
+    const multi_exp_density_plan<libff::Fr<ppT> > L_plan(density, const_padded_assignment.begin(), mpk.L_query_size, multi_exp_offset_index(num_inputs + 1),
+                                                         true);
+
+    const size_t B_num_bases = std::lower_bound(mpk.B_indices, mpk.B_indices + mpk.B_query_size, num_variables + 1) - mpk.B_indices;
+    const multi_exp_density_plan<libff::Fr<ppT> > B_plan(density, const_padded_assignment.begin(), B_num_bases, multi_exp_sparse_index(mpk.B_indices),
+                                                         true);
+
+    A_plan.print("A");
+    B_plan.print("B");
+    L_plan.print("L");
+    libff::leave_block("Compute witness density", false);
+
+    libff::G1<ppT> evaluation_At;
+    libff::G2<ppT> evaluation_Bt_g;
+    libff::G1<ppT> evaluation_Bt_h;
+    libff::G1<ppT> evaluation_Ht;
+    libff::G1<ppT> evaluation_Lt;
+
+    std::vector<std::string> task_names;
+    std::vector<double> task_costs;
+    std::vector<std::function<void(const size_t)> > tasks;
+
+    task_names.emplace_back("Compute the polynomial H and evaluation to H-query");
+    task_costs.emplace_back(r1cs_gg_ppzksnark_zok_multi_exp_cost(0, mpk.H_query_size, num_bits) +
+                            r1cs_gg_ppzksnark_zok_fft_cost(mpk.H_query_size));
+    tasks.emplace_back([&](const size_t task_chunks) {
+        r1cs_csr_to_qap_H_coefficients(pk.constraint_matrices, const_padded_assignment, mpk.context.domain,
+                                       workspace.H, workspace.H_scratch);
+
+        const libff::Fr_vector<ppT> &coefficients_for_H = workspace.H;
+        const size_t degree = coefficients_for_H.size() - 1;
+
+        /* We are dividing degree 2(d-1) polynomial by degree d polynomial
+           and not adding a PGHR-style ZK-patch, so our H is degree d-2 */
+        assert(!coefficients_for_H[degree-2].is_zero());
+        assert(coefficients_for_H[degree-1].is_zero());
+        assert(coefficients_for_H[degree].is_zero());
+        assert(mpk.H_query_size == degree - 1);
+
+        const std::vector<libff::bigint<libff::Fr<ppT>::num_limbs> > exponents =
+            pippenger_exponents<libff::Fr<ppT> >(coefficients_for_H.begin(), degree - 1);
+        evaluation_Ht = pippenger_glv_multi_exp_bigint<libff::G1<ppT> >(
+            pippenger_array_accessor<libff::G1<ppT> >(mpk.H_query), exponents, task_chunks);
+    });
+
+    task_names.emplace_back("Compute evaluation to A-query");
+    task_costs.emplace_back(r1cs_gg_ppzksnark_zok_multi_exp_cost(A_plan.one_bases.size(), A_plan.dense_bases.size(), num_bits));
+    tasks.emplace_back([&](const size_t task_chunks) {
+        evaluation_At = multi_exp_with_density<libff::G1<ppT> >(
+            A_plan,
+            pippenger_array_accessor<libff::G1<ppT> >(mpk.A_query),
+            task_chunks);
+    });
+
+    const double B_cost = r1cs_gg_ppzksnark_zok_multi_exp_cost(B_plan.one_bases.size(), B_plan.dense_bases.size(), num_bits);
+
+    task_names.emplace_back("Compute evaluation to B-query (G2)");
+    task_costs.emplace_back(3 * B_cost);
+    tasks.emplace_back([&](const size_t task_chunks) {
+        evaluation_Bt_g = multi_exp_with_density<libff::G2<ppT> >(
+            B_plan,
+            pippenger_kc_g_accessor<libff::G2<ppT>, libff::G1<ppT> >(mpk.B_query),
+            task_chunks);
+    });
+
+    task_names.emplace_back("Compute evaluation to B-query (G1)");
+    task_costs.emplace_back(B_cost);
+    tasks.emplace_back([&](const size_t task_chunks) {
+        evaluation_Bt_h = multi_exp_with_density<libff::G1<ppT> >(
+            B_plan,
+            pippenger_kc_h_accessor<libff::G2<ppT>, libff::G1<ppT> >(mpk.B_query),
+            task_chunks);
+    });
+
+    task_names.emplace_back("Compute evaluation to L-query");
+    task_costs.emplace_back(r1cs_gg_ppzksnark_zok_multi_exp_cost(L_plan.one_bases.size(), L_plan.dense_bases.size(), num_bits));
+    tasks.emplace_back([&](const size_t task_chunks) {
+        evaluation_Lt = multi_exp_with_density<libff::G1<ppT> >(
+            L_plan,
+            pippenger_array_accessor<libff::G1<ppT> >(mpk.L_query),
+            task_chunks);
+    });
+
+    r1cs_gg_ppzksnark_zok_run_tasks(task_names, task_costs, tasks, config.overlap_tasks ? chunks : 1, chunks);
+
+    const knowledge_commitment<libff::G2<ppT>, libff::G1<ppT> > evaluation_Bt(evaluation_Bt_g, evaluation_Bt_h);
+
+    r1cs_gg_ppzksnark_zok_proof<ppT> proof = r1cs_gg_ppzksnark_zok_assemble_proof<ppT>(pk, &mpk.context, evaluation_At, evaluation_Bt, evaluation_Ht, evaluation_Lt, blinding.r, blinding.s);
+
+    libff::leave_block("Call to r1cs_gg_ppzksnark_zok_mapped_prover");
+
+    proof.print_size();
+
+    return proof;
+}
+
+} // libsnark
+
+#endif // R1CS_GG_PPZKSNARK_ZOK_MAPPED_TCC_
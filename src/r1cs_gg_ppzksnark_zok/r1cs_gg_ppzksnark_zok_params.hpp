@@ -15,6 +15,7 @@
 #include <libff/algebra/curves/public_params.hpp>
 
 #include <libsnark/relations/constraint_satisfaction_problems/r1cs/r1cs.hpp>
+#include "r1cs_gg_ppzksnark_zok/r1cs_csr_constraint_system.hpp"
 
 namespace libsnark {
 
@@ -25,6 +26,9 @@ namespace libsnark {
 template<typename ppT>
 using r1cs_gg_ppzksnark_zok_constraint_system = r1cs_constraint_system<libff::Fr<ppT> >;
 
+template<typename ppT>
+using r1cs_gg_ppzksnark_zok_constraint_matrices = r1cs_csr_constraint_system<libff::Fr<ppT> >;
+
 template<typename ppT>
 using r1cs_gg_ppzksnark_zok_primary_input = r1cs_primary_input<libff::Fr<ppT> >;
 
@@ -0,0 +1,91 @@
+/** @file
+ *****************************************************************************
+
+ Declaration of interfaces for a generator and a prover that stream the
+ proving key.
+
+ The generator writes the proving key (as operator<< would) section by
+ section as each query is computed, a buffer of points at a time, and
+ releases the evaluations of the QAP polynomials each section was computed
+ from once it is written. Neither the queries nor a serialized copy of the
+ key are ever held in memory, which bounds keygen for large circuits by the
+ QAP evaluations rather than by the key.
+
+ The prover reads a serialized r1cs_gg_ppzksnark_zok_proving_key (as written
+ by operator<<) section by section, evaluating each query a buffer at a time
+ as it is read. Only the constraint matrices and a buffer of points are held
+ in memory, rather than the whole key.
+
+ Since the constraint matrices are stored after the queries but are needed
+ to compute H, the H-query is skipped on the first pass and read again once
+ the matrices have been loaded; the stream must be seekable.
+
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef R1CS_GG_PPZKSNARK_ZOK_STREAMING_HPP_
+#define R1CS_GG_PPZKSNARK_ZOK_STREAMING_HPP_
+
+#include <istream>
+#include <ostream>
+
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok.hpp"
+
+namespace libsnark {
+
+/**
+ * A generator algorithm for the R1CS GG-ppzkSNARK writing the proving key to
+ * `pk_out` and returning the verification key.
+ *
+ * At most `buffer_size` bytes of query points are held at any time; the
+ * exponentiations use every thread when a buffer holds several blocks of
+ * 4096 points.
+ */
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_verification_key<ppT> r1cs_gg_ppzksnark_zok_streaming_generator(const r1cs_gg_ppzksnark_zok_constraint_system<ppT> &r1cs,
+                                                                                      std::ostream &pk_out,
+                                                                                      const size_t buffer_size);
+
+/**
+ * As above, consuming `r1cs` instead of copying it.
+ */
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_verification_key<ppT> r1cs_gg_ppzksnark_zok_streaming_generator(r1cs_gg_ppzksnark_zok_constraint_system<ppT> &&r1cs,
+                                                                                      std::ostream &pk_out,
+                                                                                      const size_t buffer_size);
+
+/**
+ * A prover algorithm for the R1CS GG-ppzkSNARK reading the proving key from
+ * `pk_in`, which must be positioned at the start of a serialized key.
+ *
+ * At most `buffer_size` bytes of query points are held at any time. On
+ * return the stream is positioned after the key. Throws
+ * std::invalid_argument if the stream is not seekable, or if the key is
+ * truncated, malformed or not for an assignment of this size.
+ */
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_streaming_prover(std::istream &pk_in,
+                                                                const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                                const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                                                const size_t buffer_size,
+                                                                const r1cs_gg_ppzksnark_zok_prover_config &config = r1cs_gg_ppzksnark_zok_prover_config());
+
+/**
+ * As above, with the blinding factors of `blinding` instead of random ones.
+ */
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_streaming_prover(std::istream &pk_in,
+                                                                const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                                const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                                                const size_t buffer_size,
+                                                                const r1cs_gg_ppzksnark_zok_blinding_factors<ppT> &blinding,
+                                                                const r1cs_gg_ppzksnark_zok_prover_config &config = r1cs_gg_ppzksnark_zok_prover_config());
+
+} // libsnark
+
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_streaming.tcc"
+
+#endif // R1CS_GG_PPZKSNARK_ZOK_STREAMING_HPP_
@@ -0,0 +1,654 @@
+/** @file
+ *****************************************************************************
+
+ Implementation of interfaces for a generator and a prover that stream the
+ proving key.
+
+ See r1cs_gg_ppzksnark_zok_streaming.hpp .
+
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef R1CS_GG_PPZKSNARK_ZOK_STREAMING_TCC_
+#define R1CS_GG_PPZKSNARK_ZOK_STREAMING_TCC_
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+
+#include <libff/algebra/scalar_multiplication/multiexp.hpp>
+#include <libff/common/profiling.hpp>
+#include <libff/common/serialization.hpp>
+
+#ifdef MULTICORE
+#include <omp.h>
+#endif
+
+#include "r1cs_gg_ppzksnark_zok/scalar_multiplication/multiexp_density.hpp"
+#include "r1cs_gg_ppzksnark_zok/scalar_multiplication/pippenger.hpp"
+
+namespace libsnark {
+
+/**
+ * Throw if the last read of `section` from a streamed proving key failed,
+ * as it does when the key is truncated or malformed.
+ */
+inline void r1cs_gg_ppzksnark_zok_check_read(const std::istream &in, const std::string &section)
+{
+    if (!in)
+    {
+        throw std::invalid_argument("r1cs_gg_ppzksnark_zok_streaming_prover: cannot read the " + section + " of the proving key");
+    }
+}
+
+/**
+ * Read the element count which precedes a serialized std::vector, and each
+ * part of a serialized sparse_vector.
+ */
+inline size_t r1cs_gg_ppzksnark_zok_read_size(std::istream &in, const std::string &section)
+{
+    size_t size;
+    in >> size;
+    libff::consume_newline(in);
+    r1cs_gg_ppzksnark_zok_check_read(in, section + " size");
+
+    return size;
+}
+
+/**
+ * Read a count and throw unless it is `expected`, the count implied by the
+ * assignment being proved.
+ */
+inline size_t r1cs_gg_ppzksnark_zok_read_size(std::istream &in, const std::string &section, const size_t expected)
+{
+    const size_t size = r1cs_gg_ppzksnark_zok_read_size(in, section);
+    if (size != expected)
+    {
+        throw std::invalid_argument("r1cs_gg_ppzksnark_zok_streaming_prover: the " + section + " of the proving key has " +
+                                    std::to_string(size) + " elements, the assignment needs " + std::to_string(expected));
+    }
+
+    return size;
+}
+
+/**
+ * Read the next `count` elements of a serialized vector into `buffer`.
+ */
+template<typename T>
+void r1cs_gg_ppzksnark_zok_read_elements(std::istream &in, std::vector<T> &buffer, const size_t count)
+{
+    buffer.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        in >> buffer[i];
+        libff::consume_OUTPUT_NEWLINE(in);
+    }
+}
+
+/**
+ * Read past the next `count` elements of a serialized vector, at most
+ * `buffer_elements` at a time.
+ */
+template<typename T>
+void r1cs_gg_ppzksnark_zok_skip_elements(std::istream &in, const size_t count, const size_t buffer_elements)
+{
+    std::vector<T> buffer;
+    for (size_t offset = 0; offset < count; offset += buffer_elements)
+    {
+        r1cs_gg_ppzksnark_zok_read_elements(in, buffer, std::min(buffer_elements, count - offset));
+    }
+}
+
+/**
+ * Write `buffer` as the next elements of a serialized vector.
+ */
+template<typename T>
+void r1cs_gg_ppzksnark_zok_write_elements(std::ostream &out, const std::vector<T> &buffer)
+{
+    for (const T &element : buffer)
+    {
+        out << element << OUTPUT_NEWLINE;
+    }
+}
+
+/**
+ * Write the query of the `count` points windowed_exp(coeff * scalars[i]) as
+ * a serialized std::vector, computing at most `buffer_elements` of them at a
+ * time.
+ */
+template<typename T, typename FieldT>
+void r1cs_gg_ppzksnark_zok_stream_write_query(std::ostream &out,
+                                              const size_t scalar_size,
+                                              const size_t window,
+                                              const libff::window_table<T> &table,
+                                              const FieldT &coeff,
+                                              const typename std::vector<FieldT>::const_iterator scalars,
+                                              const size_t count,
+                                              const size_t buffer_elements,
+                                              r1cs_gg_ppzksnark_zok_progress &progress,
+                                              const size_t chunks)
+{
+    out << count << "\n";
+
+    std::vector<T> buffer;
+    for (size_t offset = 0; offset < count; offset += buffer_elements)
+    {
+        buffer.resize(std::min(buffer_elements, count - offset));
+        r1cs_gg_ppzksnark_zok_batch_exp(scalar_size, window, table, coeff, scalars + offset, buffer.size(),
+                                        [&](const size_t i) -> T& { return buffer[i]; },
+                                        progress, chunks);
+        r1cs_gg_ppzksnark_zok_write_elements(out, buffer);
+    }
+}
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_verification_key<ppT> r1cs_gg_ppzksnark_zok_streaming_generator(const r1cs_gg_ppzksnark_zok_constraint_system<ppT> &r1cs,
+                                                                                      std::ostream &pk_out,
+                                                                                      const size_t buffer_size)
+{
+    return r1cs_gg_ppzksnark_zok_streaming_generator<ppT>(r1cs_gg_ppzksnark_zok_constraint_system<ppT>(r1cs), pk_out, buffer_size);
+}
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_verification_key<ppT> r1cs_gg_ppzksnark_zok_streaming_generator(r1cs_gg_ppzksnark_zok_constraint_system<ppT> &&r1cs,
+                                                                                      std::ostream &pk_out,
+                                                                                      const size_t buffer_size)
+{
+    libff::enter_block("Call to r1cs_gg_ppzksnark_zok_streaming_generator");
+
+    typedef knowledge_commitment<libff::G2<ppT>, libff::G1<ppT> > B_element_type;
+
+    const size_t G1_buffer_elements = std::max<size_t>(buffer_size / sizeof(libff::G1<ppT>), 1);
+    const size_t B_buffer_elements = std::max<size_t>(buffer_size / sizeof(B_element_type), 1);
+
+#ifdef MULTICORE
+    const size_t chunks = omp_get_max_threads(); // to override, set OMP_NUM_THREADS env var or call omp_set_num_threads()
+#else
+    const size_t chunks = 1;
+#endif
+
+    /* Make the B_query "lighter" if possible */
+    r1cs_gg_ppzksnark_zok_constraint_system<ppT> r1cs_copy(std::move(r1cs));
+    r1cs_copy.swap_AB_if_beneficial();
+
+    /* Generate secret randomness */
+    const libff::Fr<ppT> t = libff::Fr<ppT>::random_element();
+    const libff::Fr<ppT> alpha = libff::Fr<ppT>::random_element();
+    const libff::Fr<ppT> beta = libff::Fr<ppT>::random_element();
+    const libff::Fr<ppT> gamma = libff::Fr<ppT>::random_element();
+    const libff::Fr<ppT> delta = libff::Fr<ppT>::random_element();
+    const libff::Fr<ppT> gamma_inverse = gamma.inverse();
+    const libff::Fr<ppT> delta_inverse = delta.inverse();
+
+    /* The matrices are written last, but built now: the QAP is evaluated
+       from them, and the copy of the constraint system, much larger than
+       them, is released before anything else is computed */
+    libff::enter_block("Compute constraint matrices for R1CS proving key");
+    const r1cs_gg_ppzksnark_zok_constraint_matrices<ppT> constraint_matrices(r1cs_copy);
+    r1cs_copy = r1cs_gg_ppzksnark_zok_constraint_system<ppT>();
+    libff::leave_block("Compute constraint matrices for R1CS proving key");
+
+    /* A quadratic arithmetic program evaluated at t, with the densities of
+       A and B */
+    libff::bit_vector At_density;
+    libff::bit_vector Bt_density;
+    qap_instance_evaluation<libff::Fr<ppT> > qap = r1cs_csr_to_qap_instance_map_with_evaluation(constraint_matrices, t, At_density, Bt_density);
+
+    libff::print_indent(); printf("* QAP number of variables: %zu\n", qap.num_variables());
+    libff::print_indent(); printf("* QAP pre degree: %zu\n", constraint_matrices.num_constraints());
+    libff::print_indent(); printf("* QAP degree: %zu\n", qap.degree());
+    libff::print_indent(); printf("* QAP number of input variables: %zu\n", qap.num_inputs());
+
+    const size_t num_variables = qap.num_variables();
+    const size_t num_inputs = qap.num_inputs();
+
+    /* qap.{At,Bt,Ct,Ht} are now in unspecified state, but we do not use them later */
+    libff::Fr_vector<ppT> At = std::move(qap.At);
+    libff::Fr_vector<ppT> Bt = std::move(qap.Bt);
+    libff::Fr_vector<ppT> Ct = std::move(qap.Ct);
+    libff::Fr_vector<ppT> Ht = std::move(qap.Ht);
+    const libff::Fr<ppT> H_coeff = qap.Zt * delta_inverse;
+
+    const size_t non_zero_At = std::count(At_density.begin(), At_density.end(), true);
+    const size_t non_zero_Bt = std::count(Bt_density.begin(), Bt_density.end(), true);
+
+    /* The gamma inverse product component: (beta*A_i(t) + alpha*B_i(t) + C_i(t)) * gamma^{-1}. */
+    libff::enter_block("Compute gamma_ABC for R1CS verification key");
+    libff::Fr_vector<ppT> gamma_ABC;
+    gamma_ABC.reserve(num_inputs);
+
+    const libff::Fr<ppT> gamma_ABC_0 = (beta * At[0] + alpha * Bt[0] + Ct[0]) * gamma_inverse;
+    for (size_t i = 1; i < num_inputs + 1; ++i)
+    {
+        gamma_ABC.emplace_back((beta * At[i] + alpha * Bt[i] + Ct[i]) * gamma_inverse);
+    }
+    libff::leave_block("Compute gamma_ABC for R1CS verification key");
+
+    /* The delta inverse product component: (beta*A_i(t) + alpha*B_i(t) + C_i(t)) * delta^{-1}.
+       It replaces C_i(t) in place, which is not needed afterwards */
+    libff::enter_block("Compute L query for R1CS proving key");
+    const size_t Lt_offset = num_inputs + 1;
+    for (size_t i = Lt_offset; i < num_variables + 1; ++i)
+    {
+        Ct[i] = (beta * At[i] + alpha * Bt[i] + Ct[i]) * delta_inverse;
+    }
+    libff::leave_block("Compute L query for R1CS proving key");
+
+    /**
+     * Note that H for Groth's proof system is degree d-2, but the QAP
+     * reduction returns coefficients for degree d polynomial H (in
+     * style of PGHR-type proof systems)
+     */
+    Ht.resize(Ht.size() - 2);
+
+    const libff::G1<ppT> g1_generator = libff::G1<ppT>::random_element();
+    const size_t g1_scalar_count = non_zero_At + non_zero_Bt + num_variables;
+    const size_t g1_scalar_size = libff::Fr<ppT>::size_in_bits();
+    const size_t g1_window_size = libff::get_exp_window_size<libff::G1<ppT> >(g1_scalar_count);
+    libff::print_indent(); printf("* G1 window: %zu\n", g1_window_size);
+
+    const libff::G2<ppT> G2_gen = libff::G2<ppT>::random_element();
+    const size_t g2_scalar_count = non_zero_Bt;
+    const size_t g2_scalar_size = libff::Fr<ppT>::size_in_bits();
+    const size_t g2_window_size = libff::get_exp_window_size<libff::G2<ppT> >(g2_scalar_count);
+    libff::print_indent(); printf("* G2 window: %zu\n", g2_window_size);
+
+    libff::enter_block("Generating G1 MSM window table");
+    const libff::window_table<libff::G1<ppT> > g1_table = r1cs_gg_ppzksnark_zok_window_table(g1_scalar_size, g1_window_size, g1_generator, chunks);
+    libff::leave_block("Generating G1 MSM window table");
+
+    const libff::Fr<ppT> one = libff::Fr<ppT>::one();
+
+    libff::enter_block("Generate R1CS proving key");
+    const libff::G1<ppT> alpha_g1 = alpha * g1_generator;
+    const libff::G1<ppT> beta_g1 = beta * g1_generator;
+    const libff::G2<ppT> beta_g2 = beta * G2_gen;
+    const libff::G1<ppT> delta_g1 = delta * g1_generator;
+    const libff::G2<ppT> delta_g2 = delta * G2_gen;
+
+    pk_out << alpha_g1 << OUTPUT_NEWLINE;
+    pk_out << beta_g1 << OUTPUT_NEWLINE;
+    pk_out << beta_g2 << OUTPUT_NEWLINE;
+    pk_out << delta_g1 << OUTPUT_NEWLINE;
+    pk_out << delta_g2 << OUTPUT_NEWLINE;
+
+    libff::enter_block("Stream the A-query");
+    r1cs_gg_ppzksnark_zok_write_density(pk_out, At_density);
+    libff::bit_vector().swap(At_density);
+    r1cs_gg_ppzksnark_zok_progress A_progress("A-query", At.size());
+    r1cs_gg_ppzksnark_zok_stream_write_query(pk_out, g1_scalar_size, g1_window_size, g1_table, one, At.begin(), At.size(),
+                                             G1_buffer_elements, A_progress, chunks);
+    libff::Fr_vector<ppT>().swap(At);
+    libff::leave_block("Stream the A-query");
+
+    /* B_query only holds the entries with a non-zero B_i(t), which are moved
+       to the front of Bt as their indices are written */
+    libff::enter_block("Stream the B-query");
+    pk_out << Bt.size() << "\n";
+    pk_out << non_zero_Bt << "\n";
+    size_t B_size = 0;
+    for (size_t i = 0; i < Bt.size(); ++i)
+    {
+        if (Bt_density[i])
+        {
+            pk_out << i << "\n";
+            Bt[B_size++] = Bt[i];
+        }
+    }
+    assert(B_size == non_zero_Bt);
+    Bt.resize(B_size);
+
+    libff::enter_block("Generating G2 MSM window table");
+    libff::window_table<libff::G2<ppT> > g2_table = r1cs_gg_ppzksnark_zok_window_table(g2_scalar_size, g2_window_size, G2_gen, chunks);
+    libff::leave_block("Generating G2 MSM window table");
+
+    r1cs_gg_ppzksnark_zok_progress B_progress("B-query", 2 * B_size);
+    pk_out << B_size << "\n";
+
+    std::vector<B_element_type> B_buffer;
+    for (size_t offset = 0; offset < B_size; offset += B_buffer_elements)
+    {
+        B_buffer.resize(std::min(B_buffer_elements, B_size - offset));
+        const typename libff::Fr_vector<ppT>::const_iterator scalars = Bt.begin() + offset;
+        r1cs_gg_ppzksnark_zok_batch_exp(g2_scalar_size, g2_window_size, g2_table, one, scalars, B_buffer.size(),
+                                        [&](const size_t i) -> libff::G2<ppT>& { return B_buffer[i].g; },
+                                        B_progress, chunks);
+        r1cs_gg_ppzksnark_zok_batch_exp(g1_scalar_size, g1_window_size, g1_table, one, scalars, B_buffer.size(),
+                                        [&](const size_t i) -> libff::G1<ppT>& { return B_buffer[i].h; },
+                                        B_progress, chunks);
+        r1cs_gg_ppzksnark_zok_write_elements(pk_out, B_buffer);
+    }
+    libff::Fr_vector<ppT>().swap(Bt);
+    libff::bit_vector().swap(Bt_density);
+    libff::window_table<libff::G2<ppT> >().swap(g2_table);
+    libff::leave_block("Stream the B-query");
+
+    libff::enter_block("Stream the H-query");
+    r1cs_gg_ppzksnark_zok_progress H_progress("H-query", Ht.size());
+    r1cs_gg_ppzksnark_zok_stream_write_query(pk_out, g1_scalar_size, g1_window_size, g1_table, H_coeff, Ht.begin(), Ht.size(),
+                                             G1_buffer_elements, H_progress, chunks);
+    libff::Fr_vector<ppT>().swap(Ht);
+    libff::leave_block("Stream the H-query");
+
+    libff::enter_block("Stream the L-query");
+    r1cs_gg_ppzksnark_zok_progress L_progress("L-query", num_variables - num_inputs);
+    r1cs_gg_ppzksnark_zok_stream_write_query(pk_out, g1_scalar_size, g1_window_size, g1_table, one, Ct.begin() + Lt_offset, num_variables - num_inputs,
+                                             G1_buffer_elements, L_progress, chunks);
+    libff::Fr_vector<ppT>().swap(Ct);
+    libff::leave_block("Stream the L-query");
+
+    pk_out << constraint_matrices;
+    pk_out.flush();
+
+    libff::leave_block("Generate R1CS proving key");
+
+    libff::enter_block("Encode gamma_ABC for R1CS verification key");
+    libff::G1_vector<ppT> gamma_ABC_g1_values(gamma_ABC.size());
+    r1cs_gg_ppzksnark_zok_progress gamma_ABC_progress("gamma_ABC", gamma_ABC.size());
+    r1cs_gg_ppzksnark_zok_batch_exp(g1_scalar_size, g1_window_size, g1_table, one, gamma_ABC.begin(), gamma_ABC.size(),
+                                    [&](const size_t i) -> libff::G1<ppT>& { return gamma_ABC_g1_values[i]; },
+                                    gamma_ABC_progress, chunks);
+    libff::leave_block("Encode gamma_ABC for R1CS verification key");
+
+    libff::G1<ppT> gamma_ABC_g1_0 = gamma_ABC_0 * g1_generator;
+    accumulation_vector<libff::G1<ppT> > gamma_ABC_g1(std::move(gamma_ABC_g1_0), std::move(gamma_ABC_g1_values));
+
+    r1cs_gg_ppzksnark_zok_verification_key<ppT> vk = r1cs_gg_ppzksnark_zok_verification_key<ppT>(alpha_g1,
+                                                                                         beta_g2,
+                                                                                         gamma * G2_gen,
+                                                                                         delta_g2,
+                                                                                         gamma_ABC_g1);
+
+    libff::leave_block("Call to r1cs_gg_ppzksnark_zok_streaming_generator");
+
+    vk.print_size();
+
+    return vk;
+}
+
+/**
+ * Evaluate a G1 query of `count` points read from `in`, where the scalar of
+ * the i-th point is const_padded_assignment[scalar_offset + i], skipping
+ * the points `query_density` marks as zero.
+ */
+template<typename ppT>
+libff::G1<ppT> r1cs_gg_ppzksnark_zok_stream_assignment_query(std::istream &in,
+                                                            const size_t count,
+                                                            const scalar_density<libff::Fr<ppT> > &density,
+                                                            const r1cs_padded_assignment<libff::Fr<ppT> > &const_padded_assignment,
+                                                            const size_t scalar_offset,
+                                                            const size_t buffer_elements,
+                                                            const bool use_pippenger,
+                                                            const size_t chunks,
+                                                            const libff::bit_vector *query_density = nullptr)
+{
+    libff::G1<ppT> result = libff::G1<ppT>::zero();
+    libff::G1_vector<ppT> buffer;
+
+    for (size_t offset = 0; offset < count; offset += buffer_elements)
+    {
+        const size_t length = std::min(buffer_elements, count - offset);
+        r1cs_gg_ppzksnark_zok_read_elements(in, buffer, length);
+
+        const multi_exp_density_plan<libff::Fr<ppT> > plan(density, const_padded_assignment.begin(), length, multi_exp_offset_index(scalar_offset + offset),
+                                                           use_pippenger, query_density);
+        result = result + multi_exp_with_density<libff::G1<ppT> >(
+            plan,
+            pippenger_vector_accessor<libff::G1<ppT> >(buffer.begin()),
+            chunks);
+    }
+
+    return result;
+}
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_streaming_prover(std::istream &pk_in,
+                                                                const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                                const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                                                const size_t buffer_size,
+                                                                const r1cs_gg_ppzksnark_zok_prover_config &config)
+{
+    return r1cs_gg_ppzksnark_zok_streaming_prover<ppT>(pk_in, primary_input, auxiliary_input, buffer_size,
+                                                       r1cs_gg_ppzksnark_zok_blinding_factors<ppT>::random(), config);
+}
+
+template<typename ppT>
+r1cs_gg_ppzksnark_zok_proof<ppT> r1cs_gg_ppzksnark_zok_streaming_prover(std::istream &pk_in,
+                                                                const r1cs_gg_ppzksnark_zok_primary_input<ppT> &primary_input,
+                                                                const r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> &auxiliary_input,
+                                                                const size_t buffer_size,
+                                                                const r1cs_gg_ppzksnark_zok_blinding_factors<ppT> &blinding,
+                                                                const r1cs_gg_ppzksnark_zok_prover_config &config)
+{
+    libff::enter_block("Call to r1cs_gg_ppzksnark_zok_streaming_prover");
+
+    typedef knowledge_commitment<libff::G2<ppT>, libff::G1<ppT> > B_element_type;
+
+    const size_t G1_buffer_elements = std::max<size_t>(buffer_size / sizeof(libff::G1<ppT>), 1);
+    const size_t B_buffer_elements = std::max<size_t>(buffer_size / sizeof(B_element_type), 1);
+
+#ifdef MULTICORE
+    const size_t chunks = omp_get_max_threads(); // to override, set OMP_NUM_THREADS env var or call omp_set_num_threads()
+#else
+    const size_t chunks = 1;
+#endif
+
+    /* Only the points used to assemble the proof are kept from the key */
+    r1cs_gg_ppzksnark_zok_proving_key<ppT> pk;
+    pk_in >> pk.alpha_g1;
+    libff::consume_OUTPUT_NEWLINE(pk_in);
+    pk_in >> pk.beta_g1;
+    libff::consume_OUTPUT_NEWLINE(pk_in);
+    pk_in >> pk.beta_g2;
+    libff::consume_OUTPUT_NEWLINE(pk_in);
+    pk_in >> pk.delta_g1;
+    libff::consume_OUTPUT_NEWLINE(pk_in);
+    pk_in >> pk.delta_g2;
+    libff::consume_OUTPUT_NEWLINE(pk_in);
+    r1cs_gg_ppzksnark_zok_check_read(pk_in, "points");
+
+    const size_t num_inputs = primary_input.size();
+    const size_t num_variables = primary_input.size() + auxiliary_input.size();
+
+    /* Two field elements, random unless chosen by the caller, for prover zero-knowledge. */
+    const libff::Fr<ppT> &r = blinding.r;
+    const libff::Fr<ppT> &s = blinding.s;
+
+    libff::enter_block("Compute witness density", false);
+    const r1cs_padded_assignment<libff::Fr<ppT> > const_padded_assignment(primary_input, auxiliary_input);
+
+    const scalar_density<libff::Fr<ppT> > density(const_padded_assignment.begin(), const_padded_assignment.end());
+    density.print();
+    libff::leave_block("Compute witness density", false);
+
+    libff::enter_block("Stream evaluation to A-query", false);
+    r1cs_gg_ppzksnark_zok_read_density(pk_in, pk.A_density);
+    r1cs_gg_ppzksnark_zok_check_read(pk_in, "A-query density");
+    const size_t A_size = r1cs_gg_ppzksnark_zok_read_size(pk_in, "A-query", num_variables + 1);
+    if (!pk.A_density.empty() && pk.A_density.size() != A_size)
+    {
+        throw std::invalid_argument("r1cs_gg_ppzksnark_zok_streaming_prover: the A-query density of the proving key does not match its A-query");
+    }
+    const libff::G1<ppT> evaluation_At = r1cs_gg_ppzksnark_zok_stream_assignment_query<ppT>(
+        pk_in, A_size, density, const_padded_assignment, 0, G1_buffer_elements,
+        config.A_query_method == r1cs_gg_ppzksnark_zok_multi_exp_pippenger, chunks, &pk.A_density);
+    r1cs_gg_ppzksnark_zok_check_read(pk_in, "A-query");
+    libff::leave_block("Stream evaluation to A-query", false);
+
+    libff::enter_block("Stream evaluation to B-query", false);
+    r1cs_gg_ppzksnark_zok_read_size(pk_in, "B-query domain", num_variables + 1);
+
+    /* The indices are kept, they are much smaller than the points */
+    const size_t B_indices_size = r1cs_gg_ppzksnark_zok_read_size(pk_in, "B-query indices");
+    if (B_indices_size > num_variables + 1)
+    {
+        throw std::invalid_argument("r1cs_gg_ppzksnark_zok_streaming_prover: the B-query of the proving key has more indices than variables");
+    }
+    std::vector<size_t> B_indices(B_indices_size);
+    for (size_t i = 0; i < B_indices.size(); ++i)
+    {
+        pk_in >> B_indices[i];
+        libff::consume_newline(pk_in);
+
+        /* The indices select densities and scalars, they must be sorted and within the variables */
+        if (B_indices[i] >= num_variables + 1 || (i > 0 && B_indices[i] <= B_indices[i - 1]))
+        {
+            r1cs_gg_ppzksnark_zok_check_read(pk_in, "B-query indices");
+            throw std::invalid_argument("r1cs_gg_ppzksnark_zok_streaming_prover: the B-query indices of the proving key are not increasing variable indices");
+        }
+    }
+    r1cs_gg_ppzksnark_zok_check_read(pk_in, "B-query indices");
+
+    const size_t B_size = r1cs_gg_ppzksnark_zok_read_size(pk_in, "B-query", B_indices.size());
+
+    const bool B_use_pippenger = (config.B_query_method == r1cs_gg_ppzksnark_zok_multi_exp_pippenger);
+    libff::G2<ppT> evaluation_Bt_g = libff::G2<ppT>::zero();
+    libff::G1<ppT> evaluation_Bt_h = libff::G1<ppT>::zero();
+    std::vector<B_element_type> B_buffer;
+
+    /* The G2 half costs about three times the G1 half, both are timed */
+    long long B_g_nsec = 0;
+    long long B_h_nsec = 0;
+
+    for (size_t offset = 0; offset < B_size; offset += B_buffer_elements)
+    {
+        const size_t length = std::min(B_buffer_elements, B_size - offset);
+        r1cs_gg_ppzksnark_zok_read_elements(pk_in, B_buffer, length);
+
+        const multi_exp_density_plan<libff::Fr<ppT> > plan(density, const_padded_assignment.begin(), length, multi_exp_sparse_index(B_indices, offset),
+                                                           B_use_pippenger);
+
+        const long long g_start = libff::get_nsec_time();
+        evaluation_Bt_g = evaluation_Bt_g + multi_exp_with_density<libff::G2<ppT> >(
+            plan,
+            pippenger_kc_g_accessor<libff::G2<ppT>, libff::G1<ppT> >(B_buffer, 0),
+            chunks);
+
+        const long long h_start = libff::get_nsec_time();
+        evaluation_Bt_h = evaluation_Bt_h + multi_exp_with_density<libff::G1<ppT> >(
+            plan,
+            pippenger_kc_h_accessor<libff::G2<ppT>, libff::G1<ppT> >(B_buffer, 0),
+            chunks);
+
+        B_g_nsec += h_start - g_start;
+        B_h_nsec += libff::get_nsec_time() - h_start;
+    }
+    r1cs_gg_ppzksnark_zok_check_read(pk_in, "B-query");
+
+    if (!libff::inhibit_profiling_info)
+    {
+        libff::print_indent(); printf("* Evaluation to B-query (G2): %.4fs\n", B_g_nsec * 1e-9);
+        libff::print_indent(); printf("* Evaluation to B-query (G1): %.4fs\n", B_h_nsec * 1e-9);
+    }
+
+    const B_element_type evaluation_Bt(evaluation_Bt_g, evaluation_Bt_h);
+    libff::leave_block("Stream evaluation to B-query", false);
+
+    /* H needs the constraint matrices, which come last; skip it for now */
+    const size_t H_size = r1cs_gg_ppzksnark_zok_read_size(pk_in, "H-query");
+    const std::streampos H_position = pk_in.tellg();
+    if (H_position == std::streampos(-1))
+    {
+        throw std::invalid_argument("r1cs_gg_ppzksnark_zok_streaming_prover: the proving key stream is not seekable");
+    }
+    r1cs_gg_ppzksnark_zok_skip_elements<libff::G1<ppT> >(pk_in, H_size, G1_buffer_elements);
+    r1cs_gg_ppzksnark_zok_check_read(pk_in, "H-query");
+
+    libff::enter_block("Stream evaluation to L-query", false);
+    const size_t L_size = r1cs_gg_ppzksnark_zok_read_size(pk_in, "L-query", num_variables - num_inputs);
+    const libff::G1<ppT> evaluation_Lt = r1cs_gg_ppzksnark_zok_stream_assignment_query<ppT>(
+        pk_in, L_size, density, const_padded_assignment, num_inputs + 1, G1_buffer_elements,
+        config.L_query_method == r1cs_gg_ppzksnark_zok_multi_exp_pippenger, chunks);
+    r1cs_gg_ppzksnark_zok_check_read(pk_in, "L-query");
+    libff::leave_block("Stream evaluation to L-query", false);
+
+    pk_in >> pk.constraint_matrices;
+    r1cs_gg_ppzksnark_zok_check_read(pk_in, "constraint matrices");
+    const std::streampos end_position = pk_in.tellg();
+
+    if (pk.constraint_matrices.num_inputs() != num_inputs ||
+        pk.constraint_matrices.num_variables() != num_variables)
+    {
+        throw std::invalid_argument("r1cs_gg_ppzksnark_zok_streaming_prover: the constraint matrices of the proving key do not match the assignment");
+    }
+
+    try
+    {
+        pk.constraint_matrices.validate();
+    }
+    catch (const std::invalid_argument &e)
+    {
+        throw std::invalid_argument(std::string("r1cs_gg_ppzksnark_zok_streaming_prover: malformed constraint matrices in the proving key: ") + e.what());
+    }
+#ifdef DEBUG
+    assert(pk.constraint_matrices.is_satisfied(primary_input, auxiliary_input));
+#endif
+
+    libff::enter_block("Compute the polynomial H");
+    libff::Fr_vector<ppT> coefficients_for_H;
+    {
+        const qap_evaluation_domain<libff::Fr<ppT> > domain(pk.constraint_matrices.num_constraints() + num_inputs + 1, false);
+        libff::Fr_vector<ppT> H_scratch;
+        r1cs_csr_to_qap_H_coefficients(pk.constraint_matrices, const_padded_assignment, domain, coefficients_for_H, H_scratch);
+    }
+    const size_t degree = coefficients_for_H.size() - 1;
+
+    /* We are dividing degree 2(d-1) polynomial by degree d polynomial
+       and not adding a PGHR-style ZK-patch, so our H is degree d-2 */
+    assert(!coefficients_for_H[degree-2].is_zero());
+    assert(coefficients_for_H[degree-1].is_zero());
+    assert(coefficients_for_H[degree].is_zero());
+    if (H_size != degree - 1)
+    {
+        throw std::invalid_argument("r1cs_gg_ppzksnark_zok_streaming_prover: the H-query of the proving key does not match its constraint matrices");
+    }
+    libff::leave_block("Compute the polynomial H");
+
+    /* The constraint matrices are not needed any more */
+    pk.constraint_matrices = r1cs_gg_ppzksnark_zok_constraint_matrices<ppT>();
+
+    libff::enter_block("Stream evaluation to H-query", false);
+    pk_in.seekg(H_position);
+    r1cs_gg_ppzksnark_zok_check_read(pk_in, "H-query");
+
+    libff::G1<ppT> evaluation_Ht = libff::G1<ppT>::zero();
+    libff::G1_vector<ppT> H_buffer;
+
+    for (size_t offset = 0; offset < H_size; offset += G1_buffer_elements)
+    {
+        const size_t length = std::min(G1_buffer_elements, H_size - offset);
+        r1cs_gg_ppzksnark_zok_read_elements(pk_in, H_buffer, length);
+
+        const typename libff::Fr_vector<ppT>::const_iterator scalars = coefficients_for_H.begin() + offset;
+        if (config.H_query_method == r1cs_gg_ppzksnark_zok_multi_exp_pippenger)
+        {
+            evaluation_Ht = evaluation_Ht + pippenger_multi_exp<libff::G1<ppT>, libff::Fr<ppT> >(
+                H_buffer.begin(), H_buffer.end(), scalars, scalars + length, chunks);
+        }
+        else
+        {
+            evaluation_Ht = evaluation_Ht + libff::multi_exp<libff::G1<ppT>, libff::Fr<ppT>, libff::multi_exp_method_BDLO12>(
+                H_buffer.begin(), H_buffer.end(), scalars, scalars + length, chunks);
+        }
+    }
+    r1cs_gg_ppzksnark_zok_check_read(pk_in, "H-query");
+
+    pk_in.seekg(end_position);
+    libff::leave_block("Stream evaluation to H-query", false);
+
+    r1cs_gg_ppzksnark_zok_proof<ppT> proof = r1cs_gg_ppzksnark_zok_assemble_proof<ppT>(pk, nullptr, evaluation_At, evaluation_Bt, evaluation_Ht, evaluation_Lt, r, s);
+
+    libff::leave_block("Call to r1cs_gg_ppzksnark_zok_streaming_prover");
+
+    proof.print_size();
+
+    return proof;
+}
+
+} // libsnark
+
+#endif // R1CS_GG_PPZKSNARK_ZOK_STREAMING_TCC_
@@ -0,0 +1,120 @@
+/** @file
+ *****************************************************************************
+
+ Declaration of interfaces for a view of the padded assignment of an R1CS.
+
+ The prover indexes the assignment as z = (1, x_1, ..., x_n), so that the
+ constant term and every variable have one position shared by the query
+ vectors of the key and the columns of the constraint matrices. Instead of
+ building z by copying the primary and auxiliary inputs behind a leading
+ one, the view below reads them where they are.
+
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef R1CS_PADDED_ASSIGNMENT_HPP_
+#define R1CS_PADDED_ASSIGNMENT_HPP_
+
+#include <cstddef>
+#include <iterator>
+
+#include <libsnark/relations/constraint_satisfaction_problems/r1cs/r1cs.hpp>
+
+namespace libsnark {
+
+/**
+ * Read-only z = (1, x_1, ..., x_n) over the primary and auxiliary inputs,
+ * which must outlive the view and its iterators.
+ */
+template<typename FieldT>
+class r1cs_padded_assignment {
+public:
+    class const_iterator;
+
+    r1cs_padded_assignment(const r1cs_primary_input<FieldT> &primary_input,
+                           const r1cs_auxiliary_input<FieldT> &auxiliary_input) :
+        one(FieldT::one()),
+        primary(primary_input.data()),
+        auxiliary(auxiliary_input.data()),
+        num_primary(primary_input.size()),
+        num_auxiliary(auxiliary_input.size())
+    {};
+
+    /* Iterators refer to the view itself, which must not be moved */
+    r1cs_padded_assignment(const r1cs_padded_assignment<FieldT> &other) = delete;
+    r1cs_padded_assignment<FieldT>& operator=(const r1cs_padded_assignment<FieldT> &other) = delete;
+
+    size_t size() const { return 1 + num_primary + num_auxiliary; }
+
+    const FieldT &operator[](const size_t i) const
+    {
+        /* Most lookups are of auxiliary variables */
+        if (i > num_primary)
+        {
+            return auxiliary[i - 1 - num_primary];
+        }
+        return (i == 0) ? one : primary[i - 1];
+    }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+private:
+    FieldT one;
+    const FieldT *primary;
+    const FieldT *auxiliary;
+    size_t num_primary;
+    size_t num_auxiliary;
+};
+
+/**
+ * Random-access iterator over a padded assignment, for the multi-
+ * exponentiations that take their scalars as a start iterator.
+ */
+template<typename FieldT>
+class r1cs_padded_assignment<FieldT>::const_iterator {
+public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef FieldT value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const FieldT* pointer;
+    typedef const FieldT& reference;
+
+    const_iterator() : assignment(nullptr), index(0) {};
+    const_iterator(const r1cs_padded_assignment<FieldT> *assignment, const size_t index) :
+        assignment(assignment), index(index) {};
+
+    reference operator*() const { return (*assignment)[index]; }
+    pointer operator->() const { return &(*assignment)[index]; }
+    reference operator[](const difference_type n) const { return (*assignment)[index + n]; }
+
+    const_iterator& operator++() { ++index; return *this; }
+    const_iterator operator++(int) { const_iterator old(*this); ++index; return old; }
+    const_iterator& operator--() { --index; return *this; }
+    const_iterator operator--(int) { const_iterator old(*this); --index; return old; }
+
+    const_iterator& operator+=(const difference_type n) { index += n; return *this; }
+    const_iterator& operator-=(const difference_type n) { index -= n; return *this; }
+    const_iterator operator+(const difference_type n) const { return const_iterator(assignment, index + n); }
+    const_iterator operator-(const difference_type n) const { return const_iterator(assignment, index - n); }
+    friend const_iterator operator+(const difference_type n, const const_iterator &it) { return it + n; }
+    difference_type operator-(const const_iterator &other) const { return difference_type(index) - difference_type(other.index); }
+
+    bool operator==(const const_iterator &other) const { return index == other.index && assignment == other.assignment; }
+    bool operator!=(const const_iterator &other) const { return !(*this == other); }
+    bool operator<(const const_iterator &other) const { return index < other.index; }
+    bool operator>(const const_iterator &other) const { return index > other.index; }
+    bool operator<=(const const_iterator &other) const { return index <= other.index; }
+    bool operator>=(const const_iterator &other) const { return index >= other.index; }
+
+private:
+    const r1cs_padded_assignment<FieldT> *assignment;
+    size_t index;
+};
+
+} // libsnark
+
+#endif // R1CS_PADDED_ASSIGNMENT_HPP_
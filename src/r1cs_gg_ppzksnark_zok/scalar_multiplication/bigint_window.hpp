@@ -0,0 +1,82 @@
+/** @file
+ *****************************************************************************
+
+ Helpers for slicing the binary expansion of a scalar into fixed-width
+ windows, as used by the bucket multi-exponentiation routines.
+
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef BIGINT_WINDOW_HPP_
+#define BIGINT_WINDOW_HPP_
+
+#include <cstddef>
+
+#include <libff/algebra/fields/bigint.hpp>
+
+namespace libsnark {
+
+/**
+ * Return the c-bit unsigned window of `v` starting at bit `offset`.
+ *
+ * Bits beyond the end of the bigint read as zero, and a window may straddle
+ * two limbs. Requires 0 < c < GMP_NUMB_BITS.
+ */
+template<mp_size_t n>
+size_t bigint_window(const libff::bigint<n> &v, const size_t offset, const size_t c)
+{
+    const size_t limb = offset / GMP_NUMB_BITS;
+    const size_t shift = offset % GMP_NUMB_BITS;
+
+    if (limb >= (size_t)n)
+    {
+        return 0;
+    }
+
+    mp_limb_t w = v.data[limb] >> shift;
+    if (shift + c > GMP_NUMB_BITS && limb + 1 < (size_t)n)
+    {
+        w |= v.data[limb + 1] << (GMP_NUMB_BITS - shift);
+    }
+
+    return w & ((((mp_limb_t)1) << c) - 1);
+}
+
+/**
+ * Return the k-th c-bit digit of `v` in signed (Booth) recoding.
+ *
+ * The digit is the c-bit window starting at bit k*c, plus the bit just below
+ * the window, minus 2^c times the top bit of the window:
+ *
+ *     d_k = window(k*c, c) + b_{k*c-1} - 2^c * b_{k*c+c-1}
+ *
+ * so that v = sum_k d_k * 2^{k*c} with every d_k in [-2^{c-1}, 2^{c-1}].
+ * Each digit only depends on c+1 bits of `v`, which lets windows be
+ * processed independently of each other. Covering a scalar of `num_bits`
+ * bits takes num_bits/c + 1 digits.
+ */
+template<mp_size_t n>
+long bigint_signed_window(const libff::bigint<n> &v, const size_t k, const size_t c)
+{
+    const size_t offset = k * c;
+    const size_t raw = bigint_window(v, offset, c);
+
+    long digit = (long)raw;
+    if (offset > 0 && v.test_bit(offset - 1))
+    {
+        digit += 1;
+    }
+    if (raw >> (c - 1))
+    {
+        digit -= (1l << c);
+    }
+
+    return digit;
+}
+
+} // libsnark
+
+#endif // BIGINT_WINDOW_HPP_
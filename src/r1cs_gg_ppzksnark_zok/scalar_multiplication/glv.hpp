@@ -0,0 +1,81 @@
+/** @file
+ *****************************************************************************
+
+ Declaration of interfaces for GLV scalar decomposition.
+
+ On alt_bn128 (BN254) G1, phi(x, y) = (beta * x, y), where beta is a cube
+ root of unity of the base field, is an endomorphism acting as
+ multiplication by lambda, a cube root of unity of the scalar field. Every
+ scalar k can be written k = k1 + k2 * lambda (mod r) with k1 and k2 of
+ about 127 bits (Gallant, Lambert and Vanstone), so that
+
+     k * P = k1 * P + k2 * phi(P)
+
+ replaces one 254-bit scalar multiplication with two of half the length
+ sharing their doublings. A multi-exponentiation over n bases likewise
+ becomes one over 2n bases with half-length scalars, which has half as many
+ windows to reduce and double.
+
+ The decomposition uses the short lattice basis of {(a, b) : a + b*lambda
+ = 0 mod r} and rounds k * b_i / r by a multiplication with precomputed
+ 2^256 * b_i / r, so it only takes a few multi-limb multiplications.
+
+ Other groups have no known endomorphism here and keep full-length scalars.
+
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef GLV_HPP_
+#define GLV_HPP_
+
+#include <libff/algebra/curves/alt_bn128/alt_bn128_g1.hpp>
+#include <libff/algebra/curves/alt_bn128/alt_bn128_init.hpp>
+#include <libff/algebra/fields/bigint.hpp>
+
+namespace libsnark {
+
+/**
+ * Endomorphism of a group usable for GLV decomposition; groups without one
+ * have `available` unset and nothing else.
+ */
+template<typename T>
+class glv_endomorphism {
+public:
+    static const bool available = false;
+};
+
+template<>
+class glv_endomorphism<libff::alt_bn128_G1> {
+public:
+    static const bool available = true;
+
+    static const mp_size_t num_limbs = libff::alt_bn128_r_limbs;
+    static const mp_size_t half_num_limbs = (128 + GMP_NUMB_BITS - 1) / GMP_NUMB_BITS;
+
+    /* phi(P) = lambda * P */
+    static libff::alt_bn128_G1 apply(const libff::alt_bn128_G1 &P);
+
+    /* Writes k = (-1)^k1_negative * k1 + (-1)^k2_negative * k2 * lambda
+       (mod r), with k1, k2 < 2^128, for k < r */
+    static void decompose(const libff::bigint<num_limbs> &k,
+                          libff::bigint<half_num_limbs> &k1,
+                          bool &k1_negative,
+                          libff::bigint<half_num_limbs> &k2,
+                          bool &k2_negative);
+};
+
+/**
+ * Returns k * P, as a joint double-and-add over the two halves of k when T
+ * has an endomorphism.
+ */
+template<typename T, mp_size_t n>
+T glv_scalar_mul(const T &P, const libff::bigint<n> &k);
+
+} // libsnark
+
+#include "r1cs_gg_ppzksnark_zok/scalar_multiplication/glv.tcc"
+
+#endif // GLV_HPP_
@@ -0,0 +1,166 @@
+/** @file
+ *****************************************************************************
+
+ Implementation of interfaces for GLV scalar decomposition.
+
+ See glv.hpp .
+
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef GLV_TCC_
+#define GLV_TCC_
+
+#include <algorithm>
+#include <cassert>
+#include <type_traits>
+
+namespace libsnark {
+
+/**
+ * Sets `c` to round(k * g / 2^256), for n-limb k and g with n limbs making
+ * up 256 bits.
+ */
+template<mp_size_t n>
+void glv_round_product(const libff::bigint<n> &k, const libff::bigint<n> &g, libff::bigint<n> &c)
+{
+    mp_limb_t product[2 * n];
+    mpn_mul_n(product, k.data, g.data, n);
+
+    /* Add 2^255, the top bit of limb n-1, before dropping the low half */
+    mpn_add_1(product + n - 1, product + n - 1, n + 1, ((mp_limb_t)1) << (GMP_NUMB_BITS - 1));
+    std::copy(product + n, product + 2 * n, c.data);
+}
+
+/**
+ * Sets `result` to |v| and `negative` to its sign, for n-limb v in two's
+ * complement with |v| < 2^(m * GMP_NUMB_BITS).
+ */
+template<mp_size_t n, mp_size_t m>
+void glv_signed_half(mp_limb_t *v, libff::bigint<m> &result, bool &negative)
+{
+    negative = (v[n - 1] >> (GMP_NUMB_BITS - 1)) != 0;
+    if (negative)
+    {
+        const mp_limb_t zero[n] = {0};
+        mpn_sub_n(v, zero, v, n);
+    }
+
+#ifdef DEBUG
+    for (mp_size_t i = m; i < n; ++i)
+    {
+        assert(v[i] == 0);
+    }
+#endif
+    std::copy(v, v + m, result.data);
+}
+
+inline libff::alt_bn128_G1 glv_endomorphism<libff::alt_bn128_G1>::apply(const libff::alt_bn128_G1 &P)
+{
+    /* The cube root of unity matching lambda below */
+    static const libff::alt_bn128_Fq beta(libff::bigint<libff::alt_bn128_q_limbs>("21888242871839275220042445260109153167277707414472061641714758635765020556616"));
+
+    /* x = X / Z^2, so scaling X scales x */
+    return libff::alt_bn128_G1(beta * P.X, P.Y, P.Z);
+}
+
+inline void glv_endomorphism<libff::alt_bn128_G1>::decompose(const libff::bigint<num_limbs> &k,
+                                                             libff::bigint<half_num_limbs> &k1,
+                                                             bool &k1_negative,
+                                                             libff::bigint<half_num_limbs> &k2,
+                                                             bool &k2_negative)
+{
+    static_assert(num_limbs * GMP_NUMB_BITS == 256, "scalars must take 256 bits");
+    typedef libff::bigint<num_limbs> scalar_t;
+
+    /* For lambda = 21888242871839275217838484774961031246154997185409878258781734729429964517155,
+       (a1, b1) and (a2, b2) is a reduced basis of the lattice of (a, b)
+       with a + b * lambda = 0 mod r; b1 is negative. g1 and g2 are
+       2^256 * b2 / r and 2^256 * -b1 / r, rounded down. */
+    static const scalar_t a1("147946756881789319000765030803803410728");
+    static const scalar_t minus_b1("9931322734385697763");
+    static const scalar_t a2("9931322734385697763");
+    static const scalar_t b2("147946756881789319010696353538189108491");
+    static const scalar_t g1("782660544089080853131326142527431468389");
+    static const scalar_t g2("52538187511802934231");
+
+    /* c1 = round(k * b2 / r), c2 = round(k * -b1 / r) */
+    scalar_t c1, c2;
+    glv_round_product(k, g1, c1);
+    glv_round_product(k, g2, c2);
+
+    /* Both halves are below 2^128 in absolute value, so they are computed
+       modulo 2^256 and read back as signed numbers */
+    mp_limb_t t1[2 * num_limbs], t2[2 * num_limbs], v[num_limbs];
+
+    /* k1 = k - c1 * a1 - c2 * a2 */
+    mpn_mul_n(t1, c1.data, a1.data, num_limbs);
+    mpn_mul_n(t2, c2.data, a2.data, num_limbs);
+    mpn_sub_n(v, k.data, t1, num_limbs);
+    mpn_sub_n(v, v, t2, num_limbs);
+    glv_signed_half<num_limbs>(v, k1, k1_negative);
+
+    /* k2 = -c1 * b1 - c2 * b2 */
+    mpn_mul_n(t1, c1.data, minus_b1.data, num_limbs);
+    mpn_mul_n(t2, c2.data, b2.data, num_limbs);
+    mpn_sub_n(v, t1, t2, num_limbs);
+    glv_signed_half<num_limbs>(v, k2, k2_negative);
+}
+
+template<typename T, mp_size_t n>
+T glv_scalar_mul_internal(const T &P, const libff::bigint<n> &k, std::false_type)
+{
+    return k * P;
+}
+
+template<typename T, mp_size_t n>
+T glv_scalar_mul_internal(const T &P, const libff::bigint<n> &k, std::true_type)
+{
+    typedef glv_endomorphism<T> endomorphism;
+
+    libff::bigint<endomorphism::half_num_limbs> k1, k2;
+    bool k1_negative, k2_negative;
+    endomorphism::decompose(k, k1, k1_negative, k2, k2_negative);
+
+    const T P1 = k1_negative ? -P : P;
+    const T phi_P = endomorphism::apply(P);
+    const T P2 = k2_negative ? -phi_P : phi_P;
+    const T P12 = P1 + P2;
+
+    /* Shamir's trick: one doubling per bit of the longer half */
+    T result = T::zero();
+    for (size_t i = std::max(k1.num_bits(), k2.num_bits()); i > 0; --i)
+    {
+        result = result.dbl();
+
+        const bool b1 = k1.test_bit(i - 1);
+        const bool b2 = k2.test_bit(i - 1);
+        if (b1 && b2)
+        {
+            result = result + P12;
+        }
+        else if (b1)
+        {
+            result = result + P1;
+        }
+        else if (b2)
+        {
+            result = result + P2;
+        }
+    }
+
+    return result;
+}
+
+template<typename T, mp_size_t n>
+T glv_scalar_mul(const T &P, const libff::bigint<n> &k)
+{
+    return glv_scalar_mul_internal(P, k, std::integral_constant<bool, glv_endomorphism<T>::available>());
+}
+
+} // libsnark
+
+#endif // GLV_TCC_
@@ -0,0 +1,47 @@
+/** @file
+ *****************************************************************************
+
+ Declaration of interfaces for evaluating one vector of bases against several
+ vectors of scalars at once.
+
+ When many proofs are produced with the same proving key, every proof runs
+ the same query vectors through a multi-exponentiation. Evaluating a batch of
+ witnesses together lets each base be read from memory once per window for
+ the whole batch, rather than once per window for every proof.
+
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef MULTIEXP_BATCH_HPP_
+#define MULTIEXP_BATCH_HPP_
+
+#include <cstddef>
+#include <vector>
+
+namespace libsnark {
+
+/**
+ * Computes, for every w in [0, scalar_starts.size()),
+ *
+ *     result[w] = sum_i scalar_starts[w][i] * vec_start[i]
+ *
+ * where i ranges over [0, vec_end - vec_start). Every scalar vector must hold
+ * at least that many elements.
+ *
+ * The bases are split into `chunks` ranges which are processed in parallel
+ * when MULTICORE is enabled.
+ */
+template<typename T, typename FieldT, typename ScalarIterator>
+std::vector<T> multi_exp_batch(typename std::vector<T>::const_iterator vec_start,
+                               typename std::vector<T>::const_iterator vec_end,
+                               const std::vector<ScalarIterator> &scalar_starts,
+                               const size_t chunks);
+
+} // libsnark
+
+#include "r1cs_gg_ppzksnark_zok/scalar_multiplication/multiexp_batch.tcc"
+
+#endif // MULTIEXP_BATCH_HPP_
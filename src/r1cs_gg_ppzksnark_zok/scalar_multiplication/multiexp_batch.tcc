@@ -0,0 +1,211 @@
+/** @file
+ *****************************************************************************
+
+ Implementation of interfaces for evaluating one vector of bases against
+ several vectors of scalars at once.
+
+ See multiexp_batch.hpp .
+
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef MULTIEXP_BATCH_TCC_
+#define MULTIEXP_BATCH_TCC_
+
+#include <algorithm>
+#include <cassert>
+
+#include <libff/algebra/fields/bigint.hpp>
+#include <libff/common/utils.hpp>
+
+#include "r1cs_gg_ppzksnark_zok/scalar_multiplication/bigint_window.hpp"
+
+namespace libsnark {
+
+/**
+ * Window size for the batched bucket method.
+ *
+ * Starts from the same estimate as the BDLO12 method in libff, then shrinks
+ * the window so the buckets of the whole batch stay below 2^18 entries.
+ */
+inline size_t multi_exp_batch_window_size(const size_t num_bases, const size_t batch_size)
+{
+    const size_t log2_length = libff::log2(num_bases);
+    size_t c = (log2_length < 6 ? 3 : log2_length - (log2_length / 3 - 2));
+
+    while (c > 3 && (batch_size << c) > (1ul << 18))
+    {
+        --c;
+    }
+
+    return c;
+}
+
+/**
+ * Bucket method over a single range of bases, processing every scalar
+ * vector of the batch inside the same pass over the bases.
+ *
+ * For each window the bases are walked once; each base is added into the
+ * bucket selected by every witness' window value before moving to the
+ * next base, so the base stays in cache for the whole batch.
+ */
+template<typename T, typename FieldT, typename ScalarIterator>
+std::vector<T> multi_exp_batch_inner(typename std::vector<T>::const_iterator bases,
+                                     typename std::vector<T>::const_iterator bases_end,
+                                     const std::vector<ScalarIterator> &exponents)
+{
+    const size_t length = bases_end - bases;
+    const size_t batch_size = exponents.size();
+
+    std::vector<T> result(batch_size, T::zero());
+    if (length == 0 || batch_size == 0)
+    {
+        return result;
+    }
+
+    const size_t c = multi_exp_batch_window_size(length, batch_size);
+    const size_t num_buckets = 1ul << c;
+
+    // Exponents are interleaved so that the batch for one base is contiguous
+    std::vector<libff::bigint<FieldT::num_limbs> > bn_exponents(length * batch_size);
+    size_t num_bits = 0;
+
+    for (size_t i = 0; i < length; ++i)
+    {
+        for (size_t w = 0; w < batch_size; ++w)
+        {
+            bn_exponents[i * batch_size + w] = exponents[w][i].as_bigint();
+            num_bits = std::max(num_bits, bn_exponents[i * batch_size + w].num_bits());
+        }
+    }
+
+    const size_t num_groups = (num_bits + c - 1) / c;
+
+    std::vector<T> buckets(batch_size * num_buckets);
+    std::vector<bool> bucket_nonzero(batch_size * num_buckets);
+    std::vector<bool> result_nonzero(batch_size, false);
+
+    for (size_t k = num_groups - 1; k < num_groups; --k)
+    {
+        for (size_t w = 0; w < batch_size; ++w)
+        {
+            if (result_nonzero[w])
+            {
+                for (size_t i = 0; i < c; ++i)
+                {
+                    result[w] = result[w].dbl();
+                }
+            }
+        }
+
+        std::fill(bucket_nonzero.begin(), bucket_nonzero.end(), false);
+
+        for (size_t i = 0; i < length; ++i)
+        {
+            const T &base = bases[i];
+
+            for (size_t w = 0; w < batch_size; ++w)
+            {
+                const size_t id = bigint_window(bn_exponents[i * batch_size + w], k * c, c);
+                if (id == 0)
+                {
+                    continue;
+                }
+
+                const size_t slot = w * num_buckets + id;
+                if (bucket_nonzero[slot])
+                {
+#ifdef USE_MIXED_ADDITION
+                    buckets[slot] = buckets[slot].mixed_add(base);
+#else
+                    buckets[slot] = buckets[slot] + base;
+#endif
+                }
+                else
+                {
+                    buckets[slot] = base;
+                    bucket_nonzero[slot] = true;
+                }
+            }
+        }
+
+        for (size_t w = 0; w < batch_size; ++w)
+        {
+            T running_sum;
+            bool running_sum_nonzero = false;
+
+            for (size_t id = num_buckets - 1; id > 0; --id)
+            {
+                const size_t slot = w * num_buckets + id;
+                if (bucket_nonzero[slot])
+                {
+                    running_sum = running_sum_nonzero ? running_sum + buckets[slot] : buckets[slot];
+                    running_sum_nonzero = true;
+                }
+
+                if (running_sum_nonzero)
+                {
+                    result[w] = result_nonzero[w] ? result[w] + running_sum : running_sum;
+                    result_nonzero[w] = true;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+template<typename T, typename FieldT, typename ScalarIterator>
+std::vector<T> multi_exp_batch(typename std::vector<T>::const_iterator vec_start,
+                               typename std::vector<T>::const_iterator vec_end,
+                               const std::vector<ScalarIterator> &scalar_starts,
+                               const size_t chunks)
+{
+    const size_t total = vec_end - vec_start;
+    const size_t batch_size = scalar_starts.size();
+
+    if ((total < chunks) || (chunks <= 1))
+    {
+        return multi_exp_batch_inner<T, FieldT>(vec_start, vec_end, scalar_starts);
+    }
+
+    const size_t one = total / chunks;
+
+    std::vector<std::vector<T> > partial(chunks);
+
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
+    for (size_t i = 0; i < chunks; ++i)
+    {
+        std::vector<ScalarIterator> chunk_scalars;
+        chunk_scalars.reserve(batch_size);
+        for (size_t w = 0; w < batch_size; ++w)
+        {
+            chunk_scalars.emplace_back(scalar_starts[w] + i * one);
+        }
+
+        partial[i] = multi_exp_batch_inner<T, FieldT>(
+            vec_start + i * one,
+            (i == chunks - 1 ? vec_end : vec_start + (i + 1) * one),
+            chunk_scalars);
+    }
+
+    std::vector<T> result(batch_size, T::zero());
+    for (size_t i = 0; i < chunks; ++i)
+    {
+        for (size_t w = 0; w < batch_size; ++w)
+        {
+            result[w] = result[w] + partial[i][w];
+        }
+    }
+
+    return result;
+}
+
+} // libsnark
+
+#endif // MULTIEXP_BATCH_TCC_
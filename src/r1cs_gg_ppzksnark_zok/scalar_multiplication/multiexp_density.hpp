@@ -0,0 +1,134 @@
+/** @file
+ *****************************************************************************
+
+ Declaration of interfaces for multi-exponentiations over mostly-boolean
+ scalar vectors.
+
+ Witnesses of typical circuits (bit decompositions, Merkle path selectors,
+ lookup toggles) are dominated by scalars equal to 0 or 1. A single pass over
+ the assignment classifies every scalar; each query then drops the bases
+ whose scalar is 0, adds the bases whose scalar is 1 directly, and only runs
+ a multi-exponentiation over the remaining "dense" scalars.
+
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef MULTIEXP_DENSITY_HPP_
+#define MULTIEXP_DENSITY_HPP_
+
+#include <cstddef>
+#include <vector>
+
+#include <libff/algebra/fields/bigint.hpp>
+#include <libff/common/utils.hpp>
+
+namespace libsnark {
+
+enum scalar_kind {
+    scalar_kind_zero = 0,
+    scalar_kind_one = 1,
+    scalar_kind_dense = 2
+};
+
+/**
+ * Classification of every element of a scalar vector as 0, 1 or other.
+ */
+template<typename FieldT>
+class scalar_density {
+public:
+    std::vector<unsigned char> kinds;
+
+    size_t num_zero;
+    size_t num_one;
+    size_t num_dense;
+
+    template<typename ScalarIterator>
+    scalar_density(ScalarIterator scalar_start,
+                   ScalarIterator scalar_end);
+
+    void print() const;
+};
+
+/**
+ * Split of the bases of one query according to the kind of their scalar.
+ *
+ * `scalar_index(i)` maps the i-th base of the query to the position of its
+ * scalar in the classified vector. When `query_density` is given and not
+ * empty, the bases whose scalar position j has query_density[j] unset are
+ * known to be zero, and are skipped whatever their scalar.
+ *
+ * The dense scalars are kept in the form the chosen method consumes: as
+ * canonical exponents for the signed-digit bucket method, and as field
+ * elements for libff's BDLO12 method.
+ */
+template<typename FieldT>
+class multi_exp_density_plan {
+public:
+    size_t num_bases;
+    bool use_pippenger;
+
+    std::vector<size_t> one_bases;
+    std::vector<size_t> dense_bases;
+
+    /* Dense scalars in the order of dense_bases, only the one used by the
+       method is filled */
+    std::vector<libff::bigint<FieldT::num_limbs> > dense_exponents;
+    std::vector<FieldT> dense_scalars;
+
+    template<typename ScalarIterator, typename IndexMap>
+    multi_exp_density_plan(const scalar_density<FieldT> &density,
+                           ScalarIterator scalar_start,
+                           const size_t num_bases,
+                           const IndexMap &scalar_index,
+                           const bool use_pippenger,
+                           const libff::bit_vector *query_density = nullptr);
+
+    void print(const char *name) const;
+};
+
+/**
+ * Maps base i to scalar i + offset.
+ */
+class multi_exp_offset_index {
+public:
+    size_t offset;
+
+    multi_exp_offset_index(const size_t offset) : offset(offset) {}
+
+    size_t operator()(const size_t i) const { return i + offset; }
+};
+
+/**
+ * Maps base i to scalar indices[offset + i], as for the entries of a sparse
+ * vector.
+ */
+class multi_exp_sparse_index {
+public:
+    const size_t *indices;
+
+    multi_exp_sparse_index(const std::vector<size_t> &indices, const size_t offset = 0) : indices(indices.data() + offset) {}
+    multi_exp_sparse_index(const size_t *indices) : indices(indices) {}
+
+    size_t operator()(const size_t i) const { return indices[i]; }
+};
+
+/**
+ * Computes sum_i scalar(i) * base(i) for the query described by `plan`.
+ *
+ * The dense scalars are evaluated with the method the plan was built for.
+ * The signed-digit bucket method reads the bases through `base`; libff's
+ * BDLO12 method takes a vector, so the dense bases are copied into one.
+ */
+template<typename T, typename FieldT, typename BaseAccessor>
+T multi_exp_with_density(const multi_exp_density_plan<FieldT> &plan,
+                         const BaseAccessor &base,
+                         const size_t chunks);
+
+} // libsnark
+
+#include "r1cs_gg_ppzksnark_zok/scalar_multiplication/multiexp_density.tcc"
+
+#endif // MULTIEXP_DENSITY_HPP_
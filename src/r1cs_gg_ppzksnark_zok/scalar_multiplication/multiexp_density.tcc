@@ -0,0 +1,240 @@
+/** @file
+ *****************************************************************************
+
+ Implementation of interfaces for multi-exponentiations over mostly-boolean
+ scalar vectors.
+
+ See multiexp_density.hpp .
+
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef MULTIEXP_DENSITY_TCC_
+#define MULTIEXP_DENSITY_TCC_
+
+#include <algorithm>
+#include <cstdio>
+
+#ifdef MULTICORE
+#include <omp.h>
+#endif
+
+#include <libff/algebra/scalar_multiplication/multiexp.hpp>
+#include <libff/common/profiling.hpp>
+
+#include "r1cs_gg_ppzksnark_zok/scalar_multiplication/pippenger.hpp"
+
+namespace libsnark {
+
+template<typename FieldT>
+template<typename ScalarIterator>
+scalar_density<FieldT>::scalar_density(ScalarIterator scalar_start,
+                                       ScalarIterator scalar_end) :
+    kinds(scalar_end - scalar_start),
+    num_zero(0),
+    num_one(0),
+    num_dense(0)
+{
+    const size_t length = scalar_end - scalar_start;
+    const FieldT one = FieldT::one();
+
+    size_t zeros = 0;
+    size_t ones = 0;
+
+#ifdef MULTICORE
+#pragma omp parallel for reduction(+:zeros,ones)
+#endif
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (scalar_start[i].is_zero())
+        {
+            kinds[i] = scalar_kind_zero;
+            ++zeros;
+        }
+        else if (scalar_start[i] == one)
+        {
+            kinds[i] = scalar_kind_one;
+            ++ones;
+        }
+        else
+        {
+            kinds[i] = scalar_kind_dense;
+        }
+    }
+
+    this->num_zero = zeros;
+    this->num_one = ones;
+    this->num_dense = length - zeros - ones;
+}
+
+template<typename FieldT>
+void scalar_density<FieldT>::print() const
+{
+    if (libff::inhibit_profiling_info)
+    {
+        return;
+    }
+
+    const double total = std::max<size_t>(kinds.size(), 1);
+    libff::print_indent(); printf("* Zero scalars in assignment: %zu (%0.2f%%)\n", num_zero, 100. * num_zero / total);
+    libff::print_indent(); printf("* One scalars in assignment: %zu (%0.2f%%)\n", num_one, 100. * num_one / total);
+    libff::print_indent(); printf("* Dense scalars in assignment: %zu (%0.2f%%)\n", num_dense, 100. * num_dense / total);
+}
+
+template<typename FieldT>
+template<typename ScalarIterator, typename IndexMap>
+multi_exp_density_plan<FieldT>::multi_exp_density_plan(const scalar_density<FieldT> &density,
+                                                       ScalarIterator scalar_start,
+                                                       const size_t num_bases,
+                                                       const IndexMap &scalar_index,
+                                                       const bool use_pippenger,
+                                                       const libff::bit_vector *query_density) :
+    num_bases(num_bases),
+    use_pippenger(use_pippenger)
+{
+    std::vector<size_t> dense_positions;
+
+    const bool use_query_density = (query_density != nullptr && !query_density->empty());
+
+    for (size_t i = 0; i < num_bases; ++i)
+    {
+        const size_t j = scalar_index(i);
+
+        if (use_query_density && !(*query_density)[j])
+        {
+            continue;
+        }
+
+        if (density.kinds[j] == scalar_kind_one)
+        {
+            one_bases.emplace_back(i);
+        }
+        else if (density.kinds[j] == scalar_kind_dense)
+        {
+            dense_bases.emplace_back(i);
+            dense_positions.emplace_back(j);
+        }
+    }
+
+    if (use_pippenger)
+    {
+        dense_exponents.resize(dense_positions.size());
+
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
+        for (size_t i = 0; i < dense_positions.size(); ++i)
+        {
+            dense_exponents[i] = scalar_start[dense_positions[i]].as_bigint();
+        }
+    }
+    else
+    {
+        dense_scalars.resize(dense_positions.size());
+
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
+        for (size_t i = 0; i < dense_positions.size(); ++i)
+        {
+            dense_scalars[i] = scalar_start[dense_positions[i]];
+        }
+    }
+}
+
+template<typename FieldT>
+void multi_exp_density_plan<FieldT>::print(const char *name) const
+{
+    if (libff::inhibit_profiling_info)
+    {
+        return;
+    }
+
+    const size_t num_zero = num_bases - one_bases.size() - dense_bases.size();
+    const double total = std::max<size_t>(num_bases, 1);
+    libff::print_indent(); printf("* %s-query bases skipped: %zu (%0.2f%%)\n", name, num_zero, 100. * num_zero / total);
+    libff::print_indent(); printf("* %s-query bases added directly: %zu (%0.2f%%)\n", name, one_bases.size(), 100. * one_bases.size() / total);
+    libff::print_indent(); printf("* %s-query bases in multi-exponentiation: %zu (%0.2f%%)\n", name, dense_bases.size(), 100. * dense_bases.size() / total);
+}
+
+/**
+ * Reads base(indices[i]) as the i-th base.
+ */
+template<typename BaseAccessor>
+class multi_exp_indexed_accessor {
+public:
+    const BaseAccessor &base;
+    const std::vector<size_t> &indices;
+
+    multi_exp_indexed_accessor(const BaseAccessor &base, const std::vector<size_t> &indices) :
+        base(base), indices(indices) {}
+
+    auto operator()(const size_t i) const -> decltype(base(i)) { return base(indices[i]); }
+};
+
+template<typename T, typename FieldT, typename BaseAccessor>
+T multi_exp_with_density(const multi_exp_density_plan<FieldT> &plan,
+                         const BaseAccessor &base,
+                         const size_t chunks)
+{
+    const size_t num_threads = std::max<size_t>(chunks, 1);
+
+    /* Bases with scalar 1 are summed directly, in `num_threads` ranges */
+    const size_t num_ones = plan.one_bases.size();
+    std::vector<T> one_sums(num_threads, T::zero());
+
+#ifdef MULTICORE
+#pragma omp parallel for num_threads(num_threads)
+#endif
+    for (size_t t = 0; t < num_threads; ++t)
+    {
+        const size_t begin = num_ones * t / num_threads;
+        const size_t end = num_ones * (t + 1) / num_threads;
+
+        T sum = T::zero();
+        for (size_t i = begin; i < end; ++i)
+        {
+#ifdef USE_MIXED_ADDITION
+            sum = sum.mixed_add(base(plan.one_bases[i]));
+#else
+            sum = sum + base(plan.one_bases[i]);
+#endif
+        }
+        one_sums[t] = sum;
+    }
+
+    T result = T::zero();
+    for (size_t t = 0; t < num_threads; ++t)
+    {
+        result = result + one_sums[t];
+    }
+
+    if (plan.dense_bases.empty())
+    {
+        return result;
+    }
+
+    if (plan.use_pippenger)
+    {
+        return result + pippenger_glv_multi_exp_bigint<T>(multi_exp_indexed_accessor<BaseAccessor>(base, plan.dense_bases),
+                                                          plan.dense_exponents, chunks);
+    }
+
+    std::vector<T> dense_bases(plan.dense_bases.size());
+    for (size_t i = 0; i < plan.dense_bases.size(); ++i)
+    {
+        dense_bases[i] = base(plan.dense_bases[i]);
+    }
+
+    return result + libff::multi_exp<T, FieldT, libff::multi_exp_method_BDLO12>(
+        dense_bases.begin(), dense_bases.end(),
+        plan.dense_scalars.begin(), plan.dense_scalars.end(),
+        chunks);
+}
+
+} // libsnark
+
+#endif // MULTIEXP_DENSITY_TCC_
@@ -0,0 +1,217 @@
+/** @file
+ *****************************************************************************
+
+ Declaration of interfaces for the signed-digit bucket multi-exponentiation
+ (Pippenger's method).
+
+ Scalars are recoded into signed c-bit digits, halving the number of buckets
+ compared with unsigned windows. The window size c is chosen from the number
+ of bases and the bit length of the scalars. Windows, and for short inputs
+ ranges of bases within a window, are processed as independent tasks, each
+ thread accumulating into its own bucket array.
+
+ The bases are supplied through an accessor, a callable mapping an index to
+ a group element, so the same routine evaluates plain vectors, projections of
+ knowledge commitments and other layouts without copying the bases.
+
+ Buckets are accumulated in Jacobian coordinates, with mixed additions of
+ the bases when USE_MIXED_ADDITION is set. With USE_BATCH_AFFINE_ADDITION
+ they are kept in affine coordinates instead: the additions into distinct
+ buckets are collected in batches whose denominators are inverted together
+ with Montgomery's trick, so that an addition costs about 6 multiplications
+ against 11 for a mixed addition, plus a share of one inversion. This needs
+ affine bases and enough buckets for batches to rarely hit one bucket twice,
+ so small windows keep Jacobian buckets.
+
+ alt_bn128 G2, the G2 half of the B-query, is the most expensive group per
+ base and has a bucket engine of its own, see pippenger_bucket_traits.
+
+ For groups with an efficient endomorphism (alt_bn128 G1), the entry points
+ below first split every scalar in two half-length ones, see glv.hpp .
+
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef PIPPENGER_HPP_
+#define PIPPENGER_HPP_
+
+#include <cstddef>
+#include <vector>
+
+#include <libff/algebra/curves/alt_bn128/alt_bn128_g2.hpp>
+#include <libff/algebra/fields/bigint.hpp>
+
+#include <libsnark/knowledge_commitment/knowledge_commitment.hpp>
+
+namespace libsnark {
+
+/**
+ * How the buckets of a window are accumulated, see above.
+ */
+enum pippenger_bucket_method {
+    pippenger_bucket_jacobian,
+    pippenger_bucket_batch_affine
+};
+
+#ifdef USE_BATCH_AFFINE_ADDITION
+const pippenger_bucket_method pippenger_default_bucket_method = pippenger_bucket_batch_affine;
+#else
+const pippenger_bucket_method pippenger_default_bucket_method = pippenger_bucket_jacobian;
+#endif
+
+/**
+ * How the buckets of windows over bases of T are accumulated and, with
+ * affine buckets, the number of additions in flight per batch, sharing one
+ * inversion; windows with fewer than `min_buckets` buckets use Jacobian
+ * buckets.
+ */
+template<typename T>
+class pippenger_bucket_traits {
+public:
+    static const pippenger_bucket_method method = pippenger_default_bucket_method;
+    static const size_t batch_size = 256;
+    static const size_t min_buckets = 4 * batch_size;
+};
+
+/**
+ * Over Fq2 an inversion costs one inversion in Fq plus a few
+ * multiplications, while a multiplication costs three in Fq: against the
+ * additions, the inversion is about three times cheaper than over Fq. G2
+ * batches are thus shorter, so that smaller windows use affine buckets, and
+ * affine buckets are used whenever the bases are kept affine
+ * (USE_MIXED_ADDITION) rather than with USE_BATCH_AFFINE_ADDITION only.
+ */
+template<>
+class pippenger_bucket_traits<libff::alt_bn128_G2> {
+public:
+#ifdef USE_MIXED_ADDITION
+    static const pippenger_bucket_method method = pippenger_bucket_batch_affine;
+#else
+    static const pippenger_bucket_method method = pippenger_bucket_jacobian;
+#endif
+    static const size_t batch_size = 64;
+    static const size_t min_buckets = 4 * batch_size;
+};
+
+/**
+ * Window size minimising the estimated number of group additions for
+ * `num_bases` scalars of `num_bits` bits.
+ */
+inline size_t pippenger_window_size(const size_t num_bases, const size_t num_bits);
+
+/**
+ * Accessor reading the bases from a vector.
+ */
+template<typename T>
+class pippenger_vector_accessor {
+public:
+    typename std::vector<T>::const_iterator bases;
+
+    pippenger_vector_accessor(typename std::vector<T>::const_iterator bases) : bases(bases) {}
+
+    const T& operator()(const size_t i) const { return bases[i]; }
+};
+
+/**
+ * Accessor reading the bases from an array, such as a mapped file.
+ */
+template<typename T>
+class pippenger_array_accessor {
+public:
+    const T *bases;
+
+    pippenger_array_accessor(const T *bases) : bases(bases) {}
+
+    const T& operator()(const size_t i) const { return bases[i]; }
+};
+
+/**
+ * Accessors reading the T1 (`g`) or T2 (`h`) half of knowledge commitments,
+ * starting at `offset` of a vector, or of an array.
+ */
+template<typename T1, typename T2>
+class pippenger_kc_g_accessor {
+public:
+    const knowledge_commitment<T1, T2> *values;
+
+    pippenger_kc_g_accessor(const std::vector<knowledge_commitment<T1, T2> > &values, const size_t offset) :
+        values(values.data() + offset) {}
+    pippenger_kc_g_accessor(const knowledge_commitment<T1, T2> *values) : values(values) {}
+
+    const T1& operator()(const size_t i) const { return values[i].g; }
+};
+
+template<typename T1, typename T2>
+class pippenger_kc_h_accessor {
+public:
+    const knowledge_commitment<T1, T2> *values;
+
+    pippenger_kc_h_accessor(const std::vector<knowledge_commitment<T1, T2> > &values, const size_t offset) :
+        values(values.data() + offset) {}
+    pippenger_kc_h_accessor(const knowledge_commitment<T1, T2> *values) : values(values) {}
+
+    const T2& operator()(const size_t i) const { return values[i].h; }
+};
+
+/**
+ * Computes sum_i exponents[i] * base(i) for i in [0, exponents.size()).
+ *
+ * Work is split across at most `chunks` threads when MULTICORE is enabled.
+ */
+template<typename T, typename BaseAccessor, mp_size_t n>
+T pippenger_multi_exp_bigint(const BaseAccessor &base,
+                             const std::vector<libff::bigint<n> > &exponents,
+                             const size_t chunks);
+
+/**
+ * As pippenger_multi_exp_bigint, with the buckets accumulated by `Method`
+ * rather than the one of pippenger_bucket_traits<T>.
+ */
+template<typename T, pippenger_bucket_method Method, typename BaseAccessor, mp_size_t n>
+T pippenger_multi_exp_bigint_method(const BaseAccessor &base,
+                                    const std::vector<libff::bigint<n> > &exponents,
+                                    const size_t chunks);
+
+/**
+ * As pippenger_multi_exp_bigint. When T has a GLV endomorphism, the base
+ * accessor is read as 2n bases, base(i) and its image, with exponents of
+ * half the length.
+ */
+template<typename T, typename BaseAccessor, mp_size_t n>
+T pippenger_glv_multi_exp_bigint(const BaseAccessor &base,
+                                 const std::vector<libff::bigint<n> > &exponents,
+                                 const size_t chunks);
+
+/**
+ * Computes sum_i scalar_start[i] * vec_start[i], with the same interface
+ * as libff::multi_exp.
+ */
+template<typename T, typename FieldT>
+T pippenger_multi_exp(typename std::vector<T>::const_iterator vec_start,
+                      typename std::vector<T>::const_iterator vec_end,
+                      typename std::vector<FieldT>::const_iterator scalar_start,
+                      typename std::vector<FieldT>::const_iterator scalar_end,
+                      const size_t chunks);
+
+/**
+ * Evaluates a knowledge commitment vector over the entries whose index lies
+ * in [min_idx, max_idx), with the same interface as
+ * kc_multi_exp_with_mixed_addition. The T1 and T2 halves are evaluated as two
+ * separate multi-exponentiations sharing one recoding of the scalars.
+ */
+template<typename T1, typename T2, typename FieldT>
+knowledge_commitment<T1, T2> kc_pippenger_multi_exp(const knowledge_commitment_vector<T1, T2> &vec,
+                                                    const size_t min_idx,
+                                                    const size_t max_idx,
+                                                    typename std::vector<FieldT>::const_iterator scalar_start,
+                                                    typename std::vector<FieldT>::const_iterator scalar_end,
+                                                    const size_t chunks);
+
+} // libsnark
+
+#include "r1cs_gg_ppzksnark_zok/scalar_multiplication/pippenger.tcc"
+
+#endif // PIPPENGER_HPP_
@@ -0,0 +1,571 @@
+/** @file
+ *****************************************************************************
+
+ Implementation of interfaces for the signed-digit bucket multi-exponentiation
+ (Pippenger's method).
+
+ See pippenger.hpp .
+
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef PIPPENGER_TCC_
+#define PIPPENGER_TCC_
+
+#include <algorithm>
+#include <cassert>
+#include <type_traits>
+
+#ifdef MULTICORE
+#include <omp.h>
+#endif
+
+#include <libff/common/utils.hpp>
+
+#include "r1cs_gg_ppzksnark_zok/scalar_multiplication/bigint_window.hpp"
+#include "r1cs_gg_ppzksnark_zok/scalar_multiplication/glv.hpp"
+
+namespace libsnark {
+
+inline size_t pippenger_window_size(const size_t num_bases, const size_t num_bits)
+{
+    /* Every window costs one addition per base plus two additions per
+       bucket to reduce the buckets; with signed digits there are 2^{c-1}
+       buckets and num_bits/c + 1 windows. Doublings between windows are
+       negligible next to either term. */
+    size_t best_c = 1;
+    size_t best_cost = 0;
+
+    for (size_t c = 1; c <= 24; ++c)
+    {
+        const size_t num_windows = num_bits / c + 1;
+        const size_t cost = num_windows * (num_bases + (1ul << c));
+
+        if (c == 1 || cost < best_cost)
+        {
+            best_c = c;
+            best_cost = cost;
+        }
+    }
+
+    return best_c;
+}
+
+/**
+ * Accumulate bases [begin, end) into buckets according to their k-th
+ * signed digit, then reduce the buckets into sum_d d * bucket[d].
+ *
+ * Bucket d-1 holds the bases whose digit is +d, plus the negation of those
+ * whose digit is -d.
+ */
+template<typename T, typename BaseAccessor, mp_size_t n>
+T pippenger_window_sum(const BaseAccessor &base,
+                       const std::vector<libff::bigint<n> > &exponents,
+                       const size_t begin,
+                       const size_t end,
+                       const size_t k,
+                       const size_t c,
+                       std::vector<T> &buckets)
+{
+    const size_t num_buckets = 1ul << (c - 1);
+    std::fill(buckets.begin(), buckets.begin() + num_buckets, T::zero());
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        const long digit = bigint_signed_window(exponents[i], k, c);
+
+        if (digit > 0)
+        {
+#ifdef USE_MIXED_ADDITION
+            buckets[digit - 1] = buckets[digit - 1].mixed_add(base(i));
+#else
+            buckets[digit - 1] = buckets[digit - 1] + base(i);
+#endif
+        }
+        else if (digit < 0)
+        {
+#ifdef USE_MIXED_ADDITION
+            buckets[-digit - 1] = buckets[-digit - 1].mixed_add(-base(i));
+#else
+            buckets[-digit - 1] = buckets[-digit - 1] + (-base(i));
+#endif
+        }
+    }
+
+    /* sum_d d * bucket[d-1], as a running sum from the highest bucket */
+    T running_sum = T::zero();
+    T sum = T::zero();
+    for (size_t d = num_buckets; d > 0; --d)
+    {
+        running_sum = running_sum + buckets[d - 1];
+        sum = sum + running_sum;
+    }
+
+    return sum;
+}
+
+/**
+ * Buckets of a window in affine coordinates.
+ *
+ * Additions are queued until a batch is full, then their denominators
+ * x2 - x1 are inverted together. A bucket takes part in at most one
+ * addition of a batch; further bases for it wait for the next batch.
+ */
+template<typename T>
+class pippenger_affine_buckets {
+public:
+    typedef decltype(T::X) coord_t;
+
+    std::vector<coord_t> x;
+    std::vector<coord_t> y;
+    std::vector<unsigned char> filled;
+    std::vector<unsigned char> busy;
+
+    explicit pippenger_affine_buckets(const size_t num_buckets) :
+        x(num_buckets), y(num_buckets), filled(num_buckets), busy(num_buckets)
+    {
+        const size_t batch_size = pippenger_bucket_traits<T>::batch_size;
+        batch_bucket.reserve(batch_size);
+        batch_x.reserve(batch_size);
+        batch_y.reserve(batch_size);
+        denominators.reserve(batch_size);
+        prefix_products.reserve(batch_size);
+    }
+
+    void clear(const size_t num_buckets)
+    {
+        std::fill(filled.begin(), filled.begin() + num_buckets, 0);
+    }
+
+    /* Adds the affine point (px, py) to bucket b */
+    void add(const size_t b, const coord_t &px, const coord_t &py)
+    {
+        if (!filled[b])
+        {
+            x[b] = px;
+            y[b] = py;
+            filled[b] = 1;
+            return;
+        }
+
+        if (busy[b])
+        {
+            deferred_bucket.emplace_back(b);
+            deferred_x.emplace_back(px);
+            deferred_y.emplace_back(py);
+            return;
+        }
+
+        if (x[b] == px)
+        {
+            /* Either the point itself, which is rare enough to be doubled
+               on its own, or its negation */
+            if (y[b] == py)
+            {
+                T P(x[b], y[b], coord_t::one());
+                P = P.dbl();
+                P.to_affine_coordinates();
+                x[b] = P.X;
+                y[b] = P.Y;
+                filled[b] = !P.is_zero();
+            }
+            else
+            {
+                filled[b] = 0;
+            }
+            return;
+        }
+
+        busy[b] = 1;
+        batch_bucket.emplace_back(b);
+        batch_x.emplace_back(px);
+        batch_y.emplace_back(py);
+        denominators.emplace_back(px - x[b]);
+    }
+
+    bool batch_full() const
+    {
+        return batch_bucket.size() >= pippenger_bucket_traits<T>::batch_size;
+    }
+
+    /* Completes the queued additions, then queues the deferred ones */
+    void flush()
+    {
+        const size_t size = batch_bucket.size();
+        if (size > 0)
+        {
+            /* prefix_products[j] is the product of the denominators before j */
+            prefix_products.resize(size);
+            coord_t product = coord_t::one();
+            for (size_t j = 0; j < size; ++j)
+            {
+                prefix_products[j] = product;
+                product = product * denominators[j];
+            }
+
+            coord_t inverse = product.inverse();
+            for (size_t j = size; j > 0; --j)
+            {
+                const size_t b = batch_bucket[j - 1];
+                const coord_t lambda = (batch_y[j - 1] - y[b]) * (inverse * prefix_products[j - 1]);
+                inverse = inverse * denominators[j - 1];
+
+                const coord_t x3 = lambda.squared() - x[b] - batch_x[j - 1];
+                y[b] = lambda * (x[b] - x3) - y[b];
+                x[b] = x3;
+                busy[b] = 0;
+            }
+
+            batch_bucket.clear();
+            batch_x.clear();
+            batch_y.clear();
+            denominators.clear();
+        }
+
+        retry_bucket.swap(deferred_bucket);
+        retry_x.swap(deferred_x);
+        retry_y.swap(deferred_y);
+        deferred_bucket.clear();
+        deferred_x.clear();
+        deferred_y.clear();
+
+        for (size_t j = 0; j < retry_bucket.size(); ++j)
+        {
+            add(retry_bucket[j], retry_x[j], retry_y[j]);
+        }
+    }
+
+    /* Flushes until no addition is left */
+    void finish()
+    {
+        while (!batch_bucket.empty() || !deferred_bucket.empty())
+        {
+            flush();
+        }
+    }
+
+    /* sum_d d * bucket[d-1], as a running sum from the highest bucket */
+    T sum(const size_t num_buckets) const
+    {
+        T running_sum = T::zero();
+        T sum = T::zero();
+        for (size_t d = num_buckets; d > 0; --d)
+        {
+            if (filled[d - 1])
+            {
+                running_sum = running_sum.mixed_add(T(x[d - 1], y[d - 1], coord_t::one()));
+            }
+            sum = sum + running_sum;
+        }
+
+        return sum;
+    }
+
+private:
+    std::vector<size_t> batch_bucket;
+    std::vector<coord_t> batch_x;
+    std::vector<coord_t> batch_y;
+    std::vector<coord_t> denominators;
+    std::vector<coord_t> prefix_products;
+
+    std::vector<size_t> deferred_bucket;
+    std::vector<coord_t> deferred_x;
+    std::vector<coord_t> deferred_y;
+
+    std::vector<size_t> retry_bucket;
+    std::vector<coord_t> retry_x;
+    std::vector<coord_t> retry_y;
+};
+
+/**
+ * As above, with affine buckets. Bases not in affine form are converted
+ * one by one, which is only cheap when USE_MIXED_ADDITION made them affine
+ * already.
+ */
+template<typename T, typename BaseAccessor, mp_size_t n>
+T pippenger_window_sum(const BaseAccessor &base,
+                       const std::vector<libff::bigint<n> > &exponents,
+                       const size_t begin,
+                       const size_t end,
+                       const size_t k,
+                       const size_t c,
+                       pippenger_affine_buckets<T> &buckets)
+{
+    const size_t num_buckets = 1ul << (c - 1);
+    buckets.clear(num_buckets);
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        const long digit = bigint_signed_window(exponents[i], k, c);
+        if (digit == 0)
+        {
+            continue;
+        }
+
+        T P = base(i);
+        if (P.is_zero())
+        {
+            continue;
+        }
+        if (!P.is_special())
+        {
+            P.to_affine_coordinates();
+        }
+
+        if (digit > 0)
+        {
+            buckets.add(digit - 1, P.X, P.Y);
+        }
+        else
+        {
+            buckets.add(-digit - 1, P.X, -P.Y);
+        }
+
+        if (buckets.batch_full())
+        {
+            buckets.flush();
+        }
+    }
+
+    buckets.finish();
+    return buckets.sum(num_buckets);
+}
+
+/**
+ * Per-thread bucket storage of each method.
+ */
+template<typename T, pippenger_bucket_method Method>
+struct pippenger_bucket_scratch {
+    typedef std::vector<T> type;
+};
+
+template<typename T>
+struct pippenger_bucket_scratch<T, pippenger_bucket_batch_affine> {
+    typedef pippenger_affine_buckets<T> type;
+};
+
+template<typename T, pippenger_bucket_method Method, typename BaseAccessor, mp_size_t n>
+T pippenger_multi_exp_bigint_method(const BaseAccessor &base,
+                                    const std::vector<libff::bigint<n> > &exponents,
+                                    const size_t chunks)
+{
+    const size_t length = exponents.size();
+
+    size_t num_bits = 0;
+    for (size_t i = 0; i < length; ++i)
+    {
+        num_bits = std::max(num_bits, exponents[i].num_bits());
+    }
+
+    if (num_bits == 0)
+    {
+        return T::zero();
+    }
+
+    const size_t c = pippenger_window_size(length, num_bits);
+    const size_t num_windows = num_bits / c + 1;
+
+    if (Method == pippenger_bucket_batch_affine && (1ul << (c - 1)) < pippenger_bucket_traits<T>::min_buckets)
+    {
+        return pippenger_multi_exp_bigint_method<T, pippenger_bucket_jacobian>(base, exponents, chunks);
+    }
+
+    /* Windows are independent tasks. When there are fewer windows than
+       threads, the bases are also split into parts so every thread gets
+       work; the parts of a window are added together afterwards. */
+    const size_t num_threads = std::max<size_t>(chunks, 1);
+    const size_t num_parts = (num_threads + num_windows - 1) / num_windows;
+    const size_t part_size = (length + num_parts - 1) / num_parts;
+    const size_t num_tasks = num_windows * num_parts;
+
+    std::vector<T> partial_sums(num_tasks, T::zero());
+
+#ifdef MULTICORE
+#pragma omp parallel num_threads(num_threads)
+#endif
+    {
+        typename pippenger_bucket_scratch<T, Method>::type buckets(1ul << (c - 1));
+
+#ifdef MULTICORE
+#pragma omp for schedule(dynamic)
+#endif
+        for (size_t task = 0; task < num_tasks; ++task)
+        {
+            const size_t k = task / num_parts;
+            const size_t begin = std::min(length, (task % num_parts) * part_size);
+            const size_t end = std::min(length, begin + part_size);
+
+            partial_sums[task] = pippenger_window_sum<T>(base, exponents, begin, end, k, c, buckets);
+        }
+    }
+
+    /* Combine the windows from the most significant one down */
+    T result = T::zero();
+    for (size_t k = num_windows; k > 0; --k)
+    {
+        if (!result.is_zero())
+        {
+            for (size_t i = 0; i < c; ++i)
+            {
+                result = result.dbl();
+            }
+        }
+
+        for (size_t p = 0; p < num_parts; ++p)
+        {
+            result = result + partial_sums[(k - 1) * num_parts + p];
+        }
+    }
+
+    return result;
+}
+
+template<typename T, typename BaseAccessor, mp_size_t n>
+T pippenger_multi_exp_bigint(const BaseAccessor &base,
+                             const std::vector<libff::bigint<n> > &exponents,
+                             const size_t chunks)
+{
+    return pippenger_multi_exp_bigint_method<T, pippenger_bucket_traits<T>::method>(base, exponents, chunks);
+}
+
+/**
+ * Reads base(i/2) for even i and its image under the endomorphism for odd
+ * i, negated where that half of the exponent is negative.
+ */
+template<typename T, typename BaseAccessor>
+class pippenger_glv_accessor {
+public:
+    const BaseAccessor &base;
+    const std::vector<unsigned char> &negated;
+
+    pippenger_glv_accessor(const BaseAccessor &base, const std::vector<unsigned char> &negated) :
+        base(base), negated(negated) {}
+
+    T operator()(const size_t i) const
+    {
+        const T P = (i & 1) ? glv_endomorphism<T>::apply(base(i / 2)) : T(base(i / 2));
+        return negated[i] ? -P : P;
+    }
+};
+
+template<typename T, typename BaseAccessor, mp_size_t n>
+T pippenger_glv_multi_exp_bigint_internal(const BaseAccessor &base,
+                                          const std::vector<libff::bigint<n> > &exponents,
+                                          const size_t chunks,
+                                          std::false_type)
+{
+    return pippenger_multi_exp_bigint<T>(base, exponents, chunks);
+}
+
+template<typename T, typename BaseAccessor, mp_size_t n>
+T pippenger_glv_multi_exp_bigint_internal(const BaseAccessor &base,
+                                          const std::vector<libff::bigint<n> > &exponents,
+                                          const size_t chunks,
+                                          std::true_type)
+{
+    typedef glv_endomorphism<T> endomorphism;
+    const size_t length = exponents.size();
+
+    /* The halves of exponent i are exponents 2i and 2i+1, so that both
+       reads of base(i) in a window are next to each other */
+    std::vector<libff::bigint<endomorphism::half_num_limbs> > half_exponents(2 * length);
+    std::vector<unsigned char> negated(2 * length);
+
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
+    for (size_t i = 0; i < length; ++i)
+    {
+        bool k1_negative, k2_negative;
+        endomorphism::decompose(exponents[i], half_exponents[2 * i], k1_negative, half_exponents[2 * i + 1], k2_negative);
+        negated[2 * i] = k1_negative;
+        negated[2 * i + 1] = k2_negative;
+    }
+
+    return pippenger_multi_exp_bigint<T>(pippenger_glv_accessor<T, BaseAccessor>(base, negated), half_exponents, chunks);
+}
+
+template<typename T, typename BaseAccessor, mp_size_t n>
+T pippenger_glv_multi_exp_bigint(const BaseAccessor &base,
+                                 const std::vector<libff::bigint<n> > &exponents,
+                                 const size_t chunks)
+{
+    return pippenger_glv_multi_exp_bigint_internal<T>(base, exponents, chunks,
+                                                      std::integral_constant<bool, glv_endomorphism<T>::available>());
+}
+
+/**
+ * Convert field elements to their canonical (non-Montgomery) representation.
+ */
+template<typename FieldT>
+std::vector<libff::bigint<FieldT::num_limbs> > pippenger_exponents(typename std::vector<FieldT>::const_iterator scalar_start,
+                                                                  const size_t length)
+{
+    std::vector<libff::bigint<FieldT::num_limbs> > exponents(length);
+
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
+    for (size_t i = 0; i < length; ++i)
+    {
+        exponents[i] = scalar_start[i].as_bigint();
+    }
+
+    return exponents;
+}
+
+template<typename T, typename FieldT>
+T pippenger_multi_exp(typename std::vector<T>::const_iterator vec_start,
+                      typename std::vector<T>::const_iterator vec_end,
+                      typename std::vector<FieldT>::const_iterator scalar_start,
+                      typename std::vector<FieldT>::const_iterator scalar_end,
+                      const size_t chunks)
+{
+    const size_t length = vec_end - vec_start;
+    assert(length == (size_t)(scalar_end - scalar_start));
+    libff::UNUSED(scalar_end);
+
+    const std::vector<libff::bigint<FieldT::num_limbs> > exponents = pippenger_exponents<FieldT>(scalar_start, length);
+
+    return pippenger_glv_multi_exp_bigint<T>(pippenger_vector_accessor<T>(vec_start), exponents, chunks);
+}
+
+template<typename T1, typename T2, typename FieldT>
+knowledge_commitment<T1, T2> kc_pippenger_multi_exp(const knowledge_commitment_vector<T1, T2> &vec,
+                                                    const size_t min_idx,
+                                                    const size_t max_idx,
+                                                    typename std::vector<FieldT>::const_iterator scalar_start,
+                                                    typename std::vector<FieldT>::const_iterator scalar_end,
+                                                    const size_t chunks)
+{
+    assert((size_t)(scalar_end - scalar_start) <= vec.domain_size_);
+    assert(max_idx <= vec.domain_size_);
+    libff::UNUSED(scalar_end);
+
+    /* The entries of a sparse vector are sorted by index, so those inside
+       [min_idx, max_idx) form one contiguous range */
+    const size_t first = std::lower_bound(vec.indices.begin(), vec.indices.end(), min_idx) - vec.indices.begin();
+    const size_t last = std::lower_bound(vec.indices.begin(), vec.indices.end(), max_idx) - vec.indices.begin();
+
+    std::vector<libff::bigint<FieldT::num_limbs> > exponents(last - first);
+
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
+    for (size_t i = first; i < last; ++i)
+    {
+        exponents[i - first] = scalar_start[vec.indices[i] - min_idx].as_bigint();
+    }
+
+    const T1 g = pippenger_glv_multi_exp_bigint<T1>(pippenger_kc_g_accessor<T1, T2>(vec.values, first), exponents, chunks);
+    const T2 h = pippenger_glv_multi_exp_bigint<T2>(pippenger_kc_h_accessor<T1, T2>(vec.values, first), exponents, chunks);
+
+    return knowledge_commitment<T1, T2>(g, h);
+}
+
+} // libsnark
+
+#endif // PIPPENGER_TCC_
@@ -0,0 +1,82 @@
+/** @file
+ *****************************************************************************
+
+ Declaration of interfaces for the fixed-base variant of the signed-digit
+ bucket multi-exponentiation.
+
+ When the same bases are used for many multi-exponentiations, the multiples
+ 2^{k*c} * P_i needed by window k can be computed once. Every window then
+ shares one set of buckets: the digits of all windows are accumulated in a
+ single pass, and only one bucket reduction is needed instead of one per
+ window, with no doublings between windows.
+
+ Storing every multiple costs num_bits/c + 1 points per base. To bound the
+ memory, only every `stride`-th multiple is stored; the windows in between
+ are reached with c doublings each, as in the variable-base method. The
+ first multiple is the base itself, which is read from the bases rather
+ than stored again; a table storing no other multiple is empty, and costs
+ as much as the variable-base method.
+
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef PIPPENGER_FIXED_BASE_HPP_
+#define PIPPENGER_FIXED_BASE_HPP_
+
+#include <cstddef>
+#include <vector>
+
+namespace libsnark {
+
+/**
+ * Precomputed multiples of a vector of bases.
+ */
+template<typename T>
+class pippenger_fixed_base_table {
+public:
+    size_t num_bases;
+    size_t num_bits;
+    size_t window_size;
+    size_t num_windows;
+    size_t stride;
+
+    /* multiples[(j - 1) * num_bases + i] = 2^{j * stride * window_size} * base_i
+       for j >= 1, the bases themselves are not stored */
+    std::vector<T> multiples;
+
+    pippenger_fixed_base_table() : num_bases(0), num_bits(0), window_size(1), num_windows(0), stride(1) {};
+
+    /**
+     * Precompute multiples of [vec_start, vec_end) for scalars of at most
+     * `num_bits` bits, storing at most `max_multiples_per_base` points for
+     * each base besides the base itself.
+     */
+    pippenger_fixed_base_table(typename std::vector<T>::const_iterator vec_start,
+                               typename std::vector<T>::const_iterator vec_end,
+                               const size_t num_bits,
+                               const size_t max_multiples_per_base);
+
+    size_t size_in_bytes() const { return multiples.size() * sizeof(T); }
+
+    /* No multiple besides the bases is stored */
+    bool empty() const { return multiples.empty(); }
+
+    /**
+     * Computes sum_i scalar_start[i] * base_i over all bases of the table,
+     * `vec_start` being the start of the bases it was computed from.
+     */
+    template<typename FieldT, typename ScalarIterator>
+    T multi_exp(typename std::vector<T>::const_iterator vec_start,
+                ScalarIterator scalar_start,
+                ScalarIterator scalar_end,
+                const size_t chunks) const;
+};
+
+} // libsnark
+
+#include "r1cs_gg_ppzksnark_zok/scalar_multiplication/pippenger_fixed_base.tcc"
+
+#endif // PIPPENGER_FIXED_BASE_HPP_
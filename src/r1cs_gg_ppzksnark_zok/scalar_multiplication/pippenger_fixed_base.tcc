@@ -0,0 +1,211 @@
+/** @file
+ *****************************************************************************
+
+ Implementation of interfaces for the fixed-base variant of the signed-digit
+ bucket multi-exponentiation.
+
+ See pippenger_fixed_base.hpp .
+
+ *****************************************************************************
+ * @author     This file is part of libsnark, developed by SCIPR Lab
+ *             and contributors (see AUTHORS).
+ * @copyright  MIT license (see LICENSE file)
+ *****************************************************************************/
+
+#ifndef PIPPENGER_FIXED_BASE_TCC_
+#define PIPPENGER_FIXED_BASE_TCC_
+
+#include <algorithm>
+#include <cassert>
+
+#ifdef MULTICORE
+#include <omp.h>
+#endif
+
+#include <libff/algebra/fields/bigint.hpp>
+#include <libff/algebra/scalar_multiplication/multiexp.hpp>
+#include <libff/common/utils.hpp>
+
+#include "r1cs_gg_ppzksnark_zok/scalar_multiplication/bigint_window.hpp"
+
+namespace libsnark {
+
+template<typename T>
+pippenger_fixed_base_table<T>::pippenger_fixed_base_table(typename std::vector<T>::const_iterator vec_start,
+                                                          typename std::vector<T>::const_iterator vec_end,
+                                                          const size_t num_bits,
+                                                          const size_t max_multiples_per_base) :
+    num_bases(vec_end - vec_start),
+    num_bits(num_bits)
+{
+    /* The base itself is always available */
+    const size_t max_multiples = max_multiples_per_base + 1;
+
+    /* Per multi-exponentiation, every window costs one addition per base,
+       and every stride offset costs two additions per bucket to reduce the
+       shared buckets. Pick the window size minimising the total under the
+       memory bound; windows above 18 bits would make the per-thread bucket
+       arrays too large. */
+    size_t best_cost = 0;
+    for (size_t c = 1; c <= 18; ++c)
+    {
+        const size_t W = num_bits / c + 1;
+        const size_t s = (W + max_multiples - 1) / max_multiples;
+        const size_t cost = num_bases * W + s * (1ul << c);
+
+        if (c == 1 || cost < best_cost)
+        {
+            best_cost = cost;
+            this->window_size = c;
+            this->num_windows = W;
+            this->stride = s;
+        }
+    }
+
+    const size_t num_multiples = (this->num_windows + this->stride - 1) / this->stride;
+    const size_t shift = this->stride * this->window_size;
+
+    this->multiples.resize((num_multiples - 1) * num_bases);
+
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
+    for (size_t i = 0; i < num_bases; ++i)
+    {
+        T P = vec_start[i];
+
+        for (size_t j = 1; j < num_multiples; ++j)
+        {
+            for (size_t b = 0; b < shift; ++b)
+            {
+                P = P.dbl();
+            }
+            this->multiples[(j - 1) * num_bases + i] = P;
+        }
+    }
+
+#ifdef USE_MIXED_ADDITION
+    libff::batch_to_special<T>(this->multiples);
+#endif
+}
+
+template<typename T>
+template<typename FieldT, typename ScalarIterator>
+T pippenger_fixed_base_table<T>::multi_exp(typename std::vector<T>::const_iterator vec_start,
+                                           ScalarIterator scalar_start,
+                                           ScalarIterator scalar_end,
+                                           const size_t chunks) const
+{
+    assert((size_t)(scalar_end - scalar_start) == num_bases);
+    libff::UNUSED(scalar_end);
+
+    const size_t c = this->window_size;
+    const size_t num_multiples = (this->num_windows + this->stride - 1) / this->stride;
+    const T *bases = (num_bases > 0) ? &*vec_start : nullptr;
+
+    std::vector<libff::bigint<FieldT::num_limbs> > exponents(num_bases);
+
+#ifdef MULTICORE
+#pragma omp parallel for
+#endif
+    for (size_t i = 0; i < num_bases; ++i)
+    {
+        exponents[i] = scalar_start[i].as_bigint();
+        assert(exponents[i].num_bits() <= num_bits);
+    }
+
+    /* Every stride offset t accumulates windows t, t + stride, t + 2*stride,
+       ... into one set of buckets. Offsets are split into ranges of bases so
+       that every thread gets work. */
+    const size_t num_threads = std::max<size_t>(chunks, 1);
+    const size_t num_parts = (num_threads + this->stride - 1) / this->stride;
+    const size_t part_size = (num_bases + num_parts - 1) / num_parts;
+    const size_t num_tasks = this->stride * num_parts;
+    const size_t num_buckets = 1ul << (c - 1);
+
+    std::vector<T> partial_sums(num_tasks, T::zero());
+
+#ifdef MULTICORE
+#pragma omp parallel num_threads(num_threads)
+#endif
+    {
+        std::vector<T> buckets(num_buckets);
+
+#ifdef MULTICORE
+#pragma omp for schedule(dynamic)
+#endif
+        for (size_t task = 0; task < num_tasks; ++task)
+        {
+            const size_t t = task / num_parts;
+            const size_t begin = std::min(num_bases, (task % num_parts) * part_size);
+            const size_t end = std::min(num_bases, begin + part_size);
+
+            std::fill(buckets.begin(), buckets.end(), T::zero());
+
+            for (size_t j = 0; j < num_multiples; ++j)
+            {
+                const size_t k = j * this->stride + t;
+                if (k >= this->num_windows)
+                {
+                    break;
+                }
+
+                const T *row = (j == 0) ? bases : this->multiples.data() + (j - 1) * num_bases;
+                for (size_t i = begin; i < end; ++i)
+                {
+                    const long digit = bigint_signed_window(exponents[i], k, c);
+
+                    if (digit > 0)
+                    {
+#ifdef USE_MIXED_ADDITION
+                        buckets[digit - 1] = buckets[digit - 1].mixed_add(row[i]);
+#else
+                        buckets[digit - 1] = buckets[digit - 1] + row[i];
+#endif
+                    }
+                    else if (digit < 0)
+                    {
+#ifdef USE_MIXED_ADDITION
+                        buckets[-digit - 1] = buckets[-digit - 1].mixed_add(-row[i]);
+#else
+                        buckets[-digit - 1] = buckets[-digit - 1] + (-row[i]);
+#endif
+                    }
+                }
+            }
+
+            T running_sum = T::zero();
+            T sum = T::zero();
+            for (size_t d = num_buckets; d > 0; --d)
+            {
+                running_sum = running_sum + buckets[d - 1];
+                sum = sum + running_sum;
+            }
+            partial_sums[task] = sum;
+        }
+    }
+
+    /* result = sum_t 2^{t*c} * S_t */
+    T result = T::zero();
+    for (size_t t = this->stride; t > 0; --t)
+    {
+        if (!result.is_zero())
+        {
+            for (size_t b = 0; b < c; ++b)
+            {
+                result = result.dbl();
+            }
+        }
+
+        for (size_t p = 0; p < num_parts; ++p)
+        {
+            result = result + partial_sums[(t - 1) * num_parts + p];
+        }
+    }
+
+    return result;
+}
+
+} // libsnark
+
+#endif // PIPPENGER_FIXED_BASE_TCC_
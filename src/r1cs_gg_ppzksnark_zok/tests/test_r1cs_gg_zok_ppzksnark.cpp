@@ -10,16 +10,60 @@
  *****************************************************************************/
 #include <cassert>
 #include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 
 #include <libff/common/profiling.hpp>
 #include <libff/common/utils.hpp>
 
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_farm.hpp"
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_incremental.hpp"
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_mapped.hpp"
 #include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_pp.hpp"
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_streaming.hpp"
+#include "r1cs_gg_ppzksnark_zok/scalar_multiplication/glv.hpp"
+#include "r1cs_gg_ppzksnark_zok/scalar_multiplication/pippenger.hpp"
 #include <libsnark/relations/constraint_satisfaction_problems/r1cs/examples/r1cs_examples.hpp>
+#include <libsnark/reductions/r1cs_to_qap/r1cs_to_qap.hpp>
 #include "r1cs_gg_ppzksnark_zok/examples/run_r1cs_gg_ppzksnark_zok.hpp"
 
 using namespace libsnark;
 
+/* A synthetic R1CS instance with the keys generated for it */
+template<typename ppT>
+class test_r1cs_gg_ppzksnark_zok_instance {
+public:
+    r1cs_example<libff::Fr<ppT> > example;
+    r1cs_gg_ppzksnark_zok_keypair<ppT> keypair;
+
+    test_r1cs_gg_ppzksnark_zok_instance(size_t num_constraints, size_t input_size) :
+        example(generate_r1cs_example_with_binary_input<libff::Fr<ppT> >(num_constraints, input_size)),
+        keypair(r1cs_gg_ppzksnark_zok_generator<ppT>(example.constraint_system))
+    {}
+
+    bool verify(const r1cs_gg_ppzksnark_zok_proof<ppT> &proof) const
+    {
+        return r1cs_gg_ppzksnark_zok_verifier_strong_IC<ppT>(keypair.vk, example.primary_input, proof);
+    }
+};
+
+/* Whether calling `f` throws an ExceptionT */
+template<typename ExceptionT, typename F>
+bool test_throws(const F &f)
+{
+    try
+    {
+        f();
+    }
+    catch (const ExceptionT &)
+    {
+        return true;
+    }
+    return false;
+}
+
 template<typename ppT>
 void test_r1cs_gg_ppzksnark_zok(size_t num_constraints,
                          size_t input_size)
@@ -30,14 +74,681 @@ void test_r1cs_gg_ppzksnark_zok(size_t num_constraints,
     r1cs_example<libff::Fr<ppT> > example = generate_r1cs_example_with_binary_input<libff::Fr<ppT> >(num_constraints, input_size);
     const bool bit = run_r1cs_gg_ppzksnark_zok<ppT>(example, test_serialization);
     assert(bit);
+    libff::UNUSED(bit);
 
     libff::print_header("(leave) Test R1CS GG-ppzkSNARK");
 }
 
+template<typename ppT>
+void test_r1cs_gg_ppzksnark_zok_constraint_matrices(size_t num_constraints,
+                                                    size_t input_size)
+{
+    libff::print_header("(enter) Test R1CS GG-ppzkSNARK constraint matrices");
+
+    typedef libff::Fr<ppT> FieldT;
+
+    r1cs_example<FieldT> example = generate_r1cs_example_with_binary_input<FieldT>(num_constraints, input_size);
+    const r1cs_gg_ppzksnark_zok_constraint_matrices<ppT> matrices(example.constraint_system);
+
+    assert(matrices.num_constraints() == example.constraint_system.num_constraints());
+    assert(matrices.num_variables() == example.constraint_system.num_variables());
+    assert(matrices.is_satisfied(example.primary_input, example.auxiliary_input));
+    assert(libff::reserialize<r1cs_gg_ppzksnark_zok_constraint_matrices<ppT> >(matrices) == matrices);
+
+    /* The padded assignment reads the inputs behind a leading one */
+    const r1cs_padded_assignment<FieldT> padded(example.primary_input, example.auxiliary_input);
+    assert(padded.end() - padded.begin() == (std::ptrdiff_t)padded.size() && padded.begin() < padded.end());
+    assert(*padded.begin() == FieldT::one() && padded.begin()[1] == example.primary_input[0]);
+    assert(padded.end()[-1] == example.auxiliary_input.back() && *(padded.end() - 1) == *(1 + padded.begin() + (padded.size() - 2)));
+
+    const qap_witness<FieldT> expected = r1cs_to_qap_witness_map(example.constraint_system, example.primary_input, example.auxiliary_input,
+                                                                 FieldT::zero(), FieldT::zero(), FieldT::zero());
+    const qap_witness<FieldT> actual = r1cs_csr_to_qap_witness_map(matrices, example.primary_input, example.auxiliary_input);
+    assert(actual.degree() == expected.degree());
+    assert(actual.coefficients_for_ABCs == expected.coefficients_for_ABCs);
+    assert(actual.coefficients_for_H == expected.coefficients_for_H);
+
+    /* The instance map evaluated over the columns of the matrices */
+    const FieldT t = FieldT::random_element();
+    const qap_instance_evaluation<FieldT> expected_at_t = r1cs_to_qap_instance_map_with_evaluation(example.constraint_system, t);
+    libff::bit_vector At_density, Bt_density;
+    const qap_instance_evaluation<FieldT> actual_at_t = r1cs_csr_to_qap_instance_map_with_evaluation(matrices, t, At_density, Bt_density);
+    assert(actual_at_t.degree() == expected_at_t.degree());
+    assert(actual_at_t.At == expected_at_t.At && actual_at_t.Bt == expected_at_t.Bt && actual_at_t.Ct == expected_at_t.Ct);
+    assert(actual_at_t.Ht == expected_at_t.Ht && actual_at_t.Zt == expected_at_t.Zt);
+
+    assert(At_density.size() == matrices.num_variables() + 1);
+    assert(Bt_density.size() == matrices.num_variables() + 1);
+    for (size_t i = 0; i < matrices.num_variables() + 1; ++i)
+    {
+        assert(At_density[i] == !expected_at_t.At[i].is_zero());
+        assert(Bt_density[i] == !expected_at_t.Bt[i].is_zero());
+    }
+
+    /* Every row is written, the leading empty ones too */
+    r1cs_csr_matrix<FieldT> matrix;
+    matrix.row_offsets = { 0, 0, 0, 2, 3 };
+    matrix.columns = { 0, 1, 1 };
+    matrix.coefficient_indices = { 0, 1, 0 };
+    matrix.coefficients.emplace_back(FieldT(2));
+    const std::vector<FieldT> z = { FieldT::one(), FieldT(3) };
+    std::vector<FieldT> rows(matrix.num_rows(), FieldT::one());
+    matrix.multiply(z, rows.begin(), 4);
+    assert(rows == std::vector<FieldT>({ FieldT::zero(), FieldT::zero(), FieldT(7), FieldT(3) }));
+
+    /* A broken witness must be rejected */
+    r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> bad_auxiliary_input = example.auxiliary_input;
+    bad_auxiliary_input[0] += FieldT::one();
+    assert(!matrices.is_satisfied(example.primary_input, bad_auxiliary_input));
+
+    libff::print_header("(leave) Test R1CS GG-ppzkSNARK constraint matrices");
+}
+
+template<typename ppT>
+void test_r1cs_gg_ppzksnark_zok_evaluation_domain(size_t min_size)
+{
+    libff::print_header("(enter) Test R1CS GG-ppzkSNARK evaluation domain");
+
+    typedef libff::Fr<ppT> FieldT;
+
+    const qap_evaluation_domain<FieldT> cached(min_size, true);
+    const qap_evaluation_domain<FieldT> uncached(min_size, false);
+    assert(cached.has_tables && !uncached.has_tables);
+    assert(cached.m == uncached.m);
+
+    std::vector<FieldT> input(cached.m);
+    for (FieldT &x : input)
+    {
+        x = FieldT::random_element();
+    }
+
+    std::vector<FieldT> a(input), b(input);
+    cached.FFT(a);
+    uncached.FFT(b);
+    assert(a == b);
+
+    cached.iFFT(a);
+    uncached.iFFT(b);
+    assert(a == b && a == input);
+
+    cached.cosetFFT(a);
+    uncached.cosetFFT(b);
+    assert(a == b);
+
+    cached.divide_by_Z_on_coset(a);
+    uncached.divide_by_Z_on_coset(b);
+    assert(a == b);
+
+    cached.icosetFFT(a);
+    uncached.icosetFFT(b);
+    assert(a == b);
+
+    libff::print_header("(leave) Test R1CS GG-ppzkSNARK evaluation domain");
+}
+
+template<typename ppT>
+void test_r1cs_gg_ppzksnark_zok_prover_context(size_t num_constraints,
+                                               size_t input_size,
+                                               size_t num_proofs)
+{
+    libff::print_header("(enter) Test R1CS GG-ppzkSNARK prover context");
+
+    const test_r1cs_gg_ppzksnark_zok_instance<ppT> instance(num_constraints, input_size);
+    const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk = instance.keypair.pk;
+    const r1cs_example<libff::Fr<ppT> > &example = instance.example;
+
+    const r1cs_gg_ppzksnark_zok_prover_context<ppT> context(pk);
+    context.print_size();
+
+    /* Proofs made in a reserved workspace never reallocate its buffers */
+    r1cs_gg_ppzksnark_zok_prover_workspace<ppT> workspace(context);
+    workspace.print_size();
+
+    const libff::Fr<ppT> *H_data = workspace.H.data();
+    const libff::Fr<ppT> *H_scratch_data = workspace.H_scratch.data();
+    libff::UNUSED(H_data, H_scratch_data);
+
+    for (size_t i = 0; i < num_proofs; ++i)
+    {
+        assert(instance.verify(r1cs_gg_ppzksnark_zok_prover<ppT>(pk, context, example.primary_input, example.auxiliary_input)));
+        assert(instance.verify(r1cs_gg_ppzksnark_zok_prover<ppT>(pk, context, workspace, example.primary_input, example.auxiliary_input)));
+        assert(workspace.H.data() == H_data && workspace.H_scratch.data() == H_scratch_data);
+    }
+
+    libff::print_header("(leave) Test R1CS GG-ppzkSNARK prover context");
+}
+
+template<typename ppT>
+void test_r1cs_gg_ppzksnark_zok_processed_verification_key(size_t num_constraints,
+                                                           size_t input_size)
+{
+    libff::print_header("(enter) Test R1CS GG-ppzkSNARK processed verification key");
+
+    const test_r1cs_gg_ppzksnark_zok_instance<ppT> instance(num_constraints, input_size);
+    const r1cs_gg_ppzksnark_zok_keypair<ppT> &keypair = instance.keypair;
+    const r1cs_example<libff::Fr<ppT> > &example = instance.example;
+
+    /* e(alpha, beta) is computed with the key and kept by its serialization */
+    const r1cs_gg_ppzksnark_zok_processed_verification_key<ppT> pvk = r1cs_gg_ppzksnark_zok_verifier_process_vk<ppT>(keypair.vk);
+    assert(pvk.vk_alpha_g1_beta_g2 == ppT::reduced_pairing(keypair.vk.alpha_g1, keypair.vk.beta_g2));
+
+    const r1cs_gg_ppzksnark_zok_processed_verification_key<ppT> reserialized_pvk = libff::reserialize<r1cs_gg_ppzksnark_zok_processed_verification_key<ppT> >(pvk);
+    assert(reserialized_pvk == pvk);
+
+    const r1cs_gg_ppzksnark_zok_proof<ppT> proof = r1cs_gg_ppzksnark_zok_prover<ppT>(keypair.pk, example.primary_input, example.auxiliary_input);
+    assert(r1cs_gg_ppzksnark_zok_online_verifier_strong_IC<ppT>(reserialized_pvk, example.primary_input, proof));
+
+    /* A proof does not verify for another input */
+    r1cs_gg_ppzksnark_zok_primary_input<ppT> other_primary_input(example.primary_input);
+    other_primary_input[0] += libff::Fr<ppT>::one();
+    assert(!r1cs_gg_ppzksnark_zok_online_verifier_strong_IC<ppT>(reserialized_pvk, other_primary_input, proof));
+
+    libff::print_header("(leave) Test R1CS GG-ppzkSNARK processed verification key");
+}
+
+template<typename ppT>
+void test_r1cs_gg_ppzksnark_zok_batch_prover(size_t num_constraints,
+                                             size_t input_size,
+                                             size_t batch_size)
+{
+    libff::print_header("(enter) Test R1CS GG-ppzkSNARK batch prover");
+
+    const test_r1cs_gg_ppzksnark_zok_instance<ppT> instance(num_constraints, input_size);
+
+    const std::vector<r1cs_gg_ppzksnark_zok_primary_input<ppT> > primary_inputs(batch_size, instance.example.primary_input);
+    const std::vector<r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> > auxiliary_inputs(batch_size, instance.example.auxiliary_input);
+
+    const std::vector<r1cs_gg_ppzksnark_zok_proof<ppT> > proofs = r1cs_gg_ppzksnark_zok_batch_prover<ppT>(instance.keypair.pk, primary_inputs, auxiliary_inputs);
+    assert(proofs.size() == batch_size);
+    for (const r1cs_gg_ppzksnark_zok_proof<ppT> &proof : proofs)
+    {
+        assert(instance.verify(proof));
+    }
+
+    libff::print_header("(leave) Test R1CS GG-ppzkSNARK batch prover");
+}
+
+template<typename ppT>
+void test_r1cs_gg_ppzksnark_zok_pippenger(size_t num_constraints,
+                                         size_t input_size)
+{
+    libff::print_header("(enter) Test R1CS GG-ppzkSNARK Pippenger prover");
+
+    const test_r1cs_gg_ppzksnark_zok_instance<ppT> instance(num_constraints, input_size);
+
+    const r1cs_gg_ppzksnark_zok_prover_config config(r1cs_gg_ppzksnark_zok_multi_exp_pippenger);
+    assert(instance.verify(r1cs_gg_ppzksnark_zok_prover<ppT>(instance.keypair.pk, instance.example.primary_input, instance.example.auxiliary_input, config)));
+
+    libff::print_header("(leave) Test R1CS GG-ppzkSNARK Pippenger prover");
+}
+
+template<typename ppT>
+void test_r1cs_gg_ppzksnark_zok_deterministic_prover(size_t num_constraints,
+                                                     size_t input_size)
+{
+    libff::print_header("(enter) Test R1CS GG-ppzkSNARK deterministic prover");
+
+    test_r1cs_gg_ppzksnark_zok_instance<ppT> instance(num_constraints, input_size);
+    r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk = instance.keypair.pk;
+    const r1cs_example<libff::Fr<ppT> > &example = instance.example;
+
+    const r1cs_gg_ppzksnark_zok_blinding_factors<ppT> blinding = r1cs_gg_ppzksnark_zok_blinding_factors<ppT>::from_seed(42);
+    assert(r1cs_gg_ppzksnark_zok_blinding_factors<ppT>::from_seed(42).r == blinding.r);
+    assert(r1cs_gg_ppzksnark_zok_blinding_factors<ppT>::from_seed(43).r != blinding.r);
+
+    /* Every prover gives the same proof for the same blinding factors */
+    const r1cs_gg_ppzksnark_zok_proof<ppT> proof = r1cs_gg_ppzksnark_zok_prover<ppT>(pk, example.primary_input, example.auxiliary_input, blinding);
+    assert(instance.verify(proof));
+
+    const r1cs_gg_ppzksnark_zok_prover_config pippenger_config(r1cs_gg_ppzksnark_zok_multi_exp_pippenger);
+    assert(r1cs_gg_ppzksnark_zok_prover<ppT>(pk, example.primary_input, example.auxiliary_input, blinding, pippenger_config) == proof);
+
+    const r1cs_gg_ppzksnark_zok_prover_context<ppT> context(pk);
+    r1cs_gg_ppzksnark_zok_prover_workspace<ppT> workspace(context);
+    assert(r1cs_gg_ppzksnark_zok_prover<ppT>(pk, context, workspace, example.primary_input, example.auxiliary_input, blinding) == proof);
+
+    const std::vector<r1cs_gg_ppzksnark_zok_proof<ppT> > batch_proofs = r1cs_gg_ppzksnark_zok_batch_prover<ppT>(
+        pk, { example.primary_input }, { example.auxiliary_input }, { blinding });
+    assert(batch_proofs.size() == 1 && batch_proofs[0] == proof);
+
+    std::stringstream pk_stream;
+    pk_stream << pk;
+    assert(r1cs_gg_ppzksnark_zok_streaming_prover<ppT>(pk_stream, example.primary_input, example.auxiliary_input, 4096, blinding) == proof);
+
+    const r1cs_gg_ppzksnark_zok_expanded_proving_key<ppT> epk(std::move(pk), 1ul << 24);
+    assert(r1cs_gg_ppzksnark_zok_prover<ppT>(epk, workspace, example.primary_input, example.auxiliary_input, blinding) == proof);
+
+    libff::print_header("(leave) Test R1CS GG-ppzkSNARK deterministic prover");
+}
+
+template<typename ppT>
+void test_r1cs_gg_ppzksnark_zok_glv(size_t num_bases)
+{
+    libff::print_header("(enter) Test GLV scalar multiplication");
+
+    typedef libff::Fr<ppT> FieldT;
+    typedef libff::G1<ppT> G1;
+
+    std::vector<G1> bases(num_bases);
+    std::vector<FieldT> scalars(num_bases);
+    G1 expected = G1::zero();
+    for (size_t i = 0; i < num_bases; ++i)
+    {
+        bases[i] = FieldT::random_element() * G1::one();
+        scalars[i] = FieldT::random_element();
+
+        const G1 product = scalars[i] * bases[i];
+        assert(glv_scalar_mul(bases[i], scalars[i].as_bigint()) == product);
+        expected = expected + product;
+    }
+
+    /* The halves of -1 and of small scalars have other signs and lengths */
+    assert(glv_scalar_mul(G1::one(), (-FieldT::one()).as_bigint()) == -G1::one());
+    assert(glv_scalar_mul(G1::one(), FieldT::zero().as_bigint()) == G1::zero());
+    assert(glv_scalar_mul(G1::one(), FieldT(3).as_bigint()) == FieldT(3) * G1::one());
+
+    assert((pippenger_multi_exp<G1, FieldT>(bases.cbegin(), bases.cend(), scalars.cbegin(), scalars.cend(), 1)) == expected);
+
+    libff::print_header("(leave) Test GLV scalar multiplication");
+}
+
+template<typename GroupT, typename FieldT>
+void test_pippenger_batch_affine_group(size_t num_bases)
+{
+    /* Repeated and negated bases make buckets double and cancel */
+    std::vector<GroupT> distinct_bases(16);
+    for (auto &P : distinct_bases)
+    {
+        P = FieldT::random_element() * GroupT::one();
+    }
+
+    std::vector<GroupT> bases(num_bases);
+    std::vector<libff::bigint<FieldT::num_limbs> > exponents(num_bases);
+    for (size_t i = 0; i < num_bases; ++i)
+    {
+        bases[i] = (i % 3 == 0) ? -distinct_bases[i % 16] : distinct_bases[i % 16];
+        exponents[i] = FieldT::random_element().as_bigint();
+    }
+    bases[1] = GroupT::zero();
+    libff::batch_to_special<GroupT>(bases);
+
+    /* Enough bases for the window to use affine buckets */
+    assert((1ul << (pippenger_window_size(num_bases, FieldT::size_in_bits()) - 1)) >= pippenger_bucket_traits<GroupT>::min_buckets);
+
+    const pippenger_vector_accessor<GroupT> accessor(bases.cbegin());
+    const GroupT expected = pippenger_multi_exp_bigint_method<GroupT, pippenger_bucket_jacobian>(accessor, exponents, 1);
+    assert((pippenger_multi_exp_bigint_method<GroupT, pippenger_bucket_batch_affine>(accessor, exponents, 4)) == expected);
+    assert(pippenger_multi_exp_bigint<GroupT>(accessor, exponents, 4) == expected);
+}
+
+template<typename ppT>
+void test_r1cs_gg_ppzksnark_zok_batch_affine(size_t num_bases)
+{
+    libff::print_header("(enter) Test batch-affine bucket accumulation");
+
+    test_pippenger_batch_affine_group<libff::G1<ppT>, libff::Fr<ppT> >(num_bases);
+
+    /* G2 batches are shorter, fewer bases are enough */
+    test_pippenger_batch_affine_group<libff::G2<ppT>, libff::Fr<ppT> >(num_bases / 8);
+
+    libff::print_header("(leave) Test batch-affine bucket accumulation");
+}
+
+template<typename ppT>
+void test_r1cs_gg_ppzksnark_zok_expanded_proving_key(size_t num_constraints,
+                                                     size_t input_size,
+                                                     size_t max_table_bytes)
+{
+    libff::print_header("(enter) Test R1CS GG-ppzkSNARK expanded proving key");
+
+    test_r1cs_gg_ppzksnark_zok_instance<ppT> instance(num_constraints, input_size);
+    const r1cs_example<libff::Fr<ppT> > &example = instance.example;
+
+    const r1cs_gg_ppzksnark_zok_expanded_proving_key<ppT> epk(std::move(instance.keypair.pk), max_table_bytes);
+    assert(epk.table_size_in_bytes() <= max_table_bytes);
+    assert(instance.verify(r1cs_gg_ppzksnark_zok_prover<ppT>(epk, example.primary_input, example.auxiliary_input)));
+
+    /* The tables, empty or not, give the proof of the plain key */
+    r1cs_gg_ppzksnark_zok_prover_workspace<ppT> workspace(epk.context);
+    const r1cs_gg_ppzksnark_zok_blinding_factors<ppT> blinding = r1cs_gg_ppzksnark_zok_blinding_factors<ppT>::from_seed(1);
+    assert(r1cs_gg_ppzksnark_zok_prover<ppT>(epk, workspace, example.primary_input, example.auxiliary_input, blinding) ==
+           r1cs_gg_ppzksnark_zok_prover<ppT>(epk.pk, example.primary_input, example.auxiliary_input, blinding));
+
+    libff::print_header("(leave) Test R1CS GG-ppzkSNARK expanded proving key");
+}
+
+template<typename ppT>
+void test_r1cs_gg_ppzksnark_zok_streaming_generator(size_t num_constraints,
+                                                    size_t input_size,
+                                                    size_t buffer_size)
+{
+    libff::print_header("(enter) Test R1CS GG-ppzkSNARK streaming generator");
+
+    const test_r1cs_gg_ppzksnark_zok_instance<ppT> instance(num_constraints, input_size);
+    const r1cs_gg_ppzksnark_zok_keypair<ppT> &keypair = instance.keypair;
+    const r1cs_example<libff::Fr<ppT> > &example = instance.example;
+
+    std::stringstream pk_stream;
+    const r1cs_gg_ppzksnark_zok_verification_key<ppT> vk = r1cs_gg_ppzksnark_zok_streaming_generator<ppT>(example.constraint_system, pk_stream, buffer_size);
+
+    /* The key has the shape of the one generated in memory */
+    r1cs_gg_ppzksnark_zok_proving_key<ppT> pk;
+    pk_stream >> pk;
+    assert(pk_stream.peek() == EOF);
+    assert(pk.A_query.size() == keypair.pk.A_query.size());
+    assert(pk.B_query.domain_size_ == keypair.pk.B_query.domain_size_ && pk.B_query.indices == keypair.pk.B_query.indices);
+    assert(pk.H_query.size() == keypair.pk.H_query.size());
+    assert(pk.L_query.size() == keypair.pk.L_query.size());
+    assert(pk.constraint_matrices == keypair.pk.constraint_matrices);
+
+    /* Consuming the constraint system makes the same key */
+    const r1cs_gg_ppzksnark_zok_keypair<ppT> consumed_keypair = r1cs_gg_ppzksnark_zok_generator<ppT>(r1cs_gg_ppzksnark_zok_constraint_system<ppT>(example.constraint_system));
+    assert(consumed_keypair.pk.A_density == keypair.pk.A_density);
+    assert(consumed_keypair.pk.B_query.indices == keypair.pk.B_query.indices);
+    assert(consumed_keypair.pk.constraint_matrices == keypair.pk.constraint_matrices);
+    assert(r1cs_gg_ppzksnark_zok_verifier_strong_IC<ppT>(consumed_keypair.vk, example.primary_input,
+                                                         r1cs_gg_ppzksnark_zok_prover<ppT>(consumed_keypair.pk, example.primary_input, example.auxiliary_input)));
+
+    /* Both provers read it as written */
+    assert(r1cs_gg_ppzksnark_zok_verifier_strong_IC<ppT>(vk, example.primary_input,
+                                                         r1cs_gg_ppzksnark_zok_prover<ppT>(pk, example.primary_input, example.auxiliary_input)));
+    pk_stream.clear();
+    pk_stream.seekg(0);
+    assert(r1cs_gg_ppzksnark_zok_verifier_strong_IC<ppT>(vk, example.primary_input,
+                                                         r1cs_gg_ppzksnark_zok_streaming_prover<ppT>(pk_stream, example.primary_input, example.auxiliary_input, buffer_size)));
+
+    libff::print_header("(leave) Test R1CS GG-ppzkSNARK streaming generator");
+}
+
+template<typename ppT>
+void test_r1cs_gg_ppzksnark_zok_streaming_prover(size_t num_constraints,
+                                                 size_t input_size,
+                                                 size_t buffer_size)
+{
+    libff::print_header("(enter) Test R1CS GG-ppzkSNARK streaming prover");
+
+    const test_r1cs_gg_ppzksnark_zok_instance<ppT> instance(num_constraints, input_size);
+    const r1cs_example<libff::Fr<ppT> > &example = instance.example;
+
+    std::stringstream pk_stream;
+    pk_stream << instance.keypair.pk;
+    assert(instance.verify(r1cs_gg_ppzksnark_zok_streaming_prover<ppT>(pk_stream, example.primary_input, example.auxiliary_input, buffer_size)));
+
+    /* The stream is left after the key */
+    assert(pk_stream.peek() == EOF);
+
+    /* Keys which are truncated, or whose B-query indices or constraint
+       matrices refer to columns past the variables, are rejected */
+    const std::string pk_string = pk_stream.str();
+
+    r1cs_gg_ppzksnark_zok_proving_key<ppT> bad_index_pk = instance.keypair.pk;
+    bad_index_pk.B_query.indices.back() = example.primary_input.size() + example.auxiliary_input.size() + 1;
+
+    r1cs_gg_ppzksnark_zok_proving_key<ppT> bad_column_pk = instance.keypair.pk;
+    bad_column_pk.constraint_matrices.B.columns.back() = bad_column_pk.constraint_matrices.num_variables() + 1;
+
+    std::stringstream bad_index_pk_stream, bad_column_pk_stream;
+    bad_index_pk_stream << bad_index_pk;
+    bad_column_pk_stream << bad_column_pk;
+
+    for (const std::string &bad_pk_string : { pk_string.substr(0, pk_string.size() / 2), bad_index_pk_stream.str(), bad_column_pk_stream.str() })
+    {
+        std::stringstream bad_pk_stream(bad_pk_string);
+        assert(test_throws<std::invalid_argument>([&]() {
+            r1cs_gg_ppzksnark_zok_streaming_prover<ppT>(bad_pk_stream, example.primary_input, example.auxiliary_input, buffer_size);
+        }));
+    }
+
+    libff::print_header("(leave) Test R1CS GG-ppzkSNARK streaming prover");
+}
+
+template<typename ppT>
+void test_r1cs_gg_ppzksnark_zok_mapped_proving_key(size_t num_constraints,
+                                                   size_t input_size)
+{
+    libff::print_header("(enter) Test R1CS GG-ppzkSNARK mapped proving key");
+
+    const test_r1cs_gg_ppzksnark_zok_instance<ppT> instance(num_constraints, input_size);
+    const r1cs_gg_ppzksnark_zok_proving_key<ppT> &pk = instance.keypair.pk;
+    const r1cs_example<libff::Fr<ppT> > &example = instance.example;
+
+    const char *path = "test_r1cs_gg_ppzksnark_zok_mapped.pk";
+    const auto write_key = [&](const r1cs_gg_ppzksnark_zok_proving_key<ppT> &key, const bool mapped) {
+        std::ofstream out(path, std::ios::binary);
+        if (mapped)
+        {
+            r1cs_gg_ppzksnark_zok_write_mapped_proving_key<ppT>(key, out);
+        }
+        else
+        {
+            out << key;
+        }
+    };
+
+    write_key(pk, true);
+    {
+        const r1cs_gg_ppzksnark_zok_mapped_proving_key<ppT> mpk(path);
+        assert(mpk.pk.constraint_matrices == pk.constraint_matrices);
+
+        r1cs_gg_ppzksnark_zok_prover_workspace<ppT> workspace(mpk.context);
+        const r1cs_gg_ppzksnark_zok_blinding_factors<ppT> blinding = r1cs_gg_ppzksnark_zok_blinding_factors<ppT>::from_seed(42);
+        assert(r1cs_gg_ppzksnark_zok_prover<ppT>(mpk, workspace, example.primary_input, example.auxiliary_input, blinding) ==
+               r1cs_gg_ppzksnark_zok_prover<ppT>(pk, example.primary_input, example.auxiliary_input, blinding));
+        assert(instance.verify(r1cs_gg_ppzksnark_zok_prover<ppT>(mpk, workspace, example.primary_input, example.auxiliary_input)));
+    }
+
+    /* Keys in the text format, whose B-query indices are out of order,
+       whose H-query is short of the evaluation domain, or whose constraint
+       matrices refer to columns past the variables, are rejected */
+    r1cs_gg_ppzksnark_zok_proving_key<ppT> unsorted_pk = pk;
+    std::swap(unsorted_pk.B_query.indices[0], unsorted_pk.B_query.indices[1]);
+
+    r1cs_gg_ppzksnark_zok_proving_key<ppT> short_H_pk = pk;
+    short_H_pk.H_query.pop_back();
+
+    r1cs_gg_ppzksnark_zok_proving_key<ppT> bad_column_pk = pk;
+    bad_column_pk.constraint_matrices.A.columns.back() = bad_column_pk.constraint_matrices.num_variables() + 1;
+
+    const r1cs_gg_ppzksnark_zok_proving_key<ppT> *bad_pks[] = { &pk, &unsorted_pk, &short_H_pk, &bad_column_pk };
+    for (const r1cs_gg_ppzksnark_zok_proving_key<ppT> *bad_pk : bad_pks)
+    {
+        write_key(*bad_pk, bad_pk != &pk);
+        assert(test_throws<std::invalid_argument>([&]() {
+            const r1cs_gg_ppzksnark_zok_mapped_proving_key<ppT> mpk(path);
+        }));
+    }
+
+    std::remove(path);
+
+    libff::print_header("(leave) Test R1CS GG-ppzkSNARK mapped proving key");
+}
+
+template<typename ppT>
+void test_r1cs_gg_ppzksnark_zok_prover_farm(size_t num_constraints,
+                                            size_t input_size,
+                                            size_t queue_depth)
+{
+    libff::print_header("(enter) Test R1CS GG-ppzkSNARK prover farm");
+
+    /* Small circuits get a lane per thread, large ones every thread */
+    const r1cs_gg_ppzksnark_zok_farm_schedule small(1000, 16, 8, 1ul << 14);
+    assert(small.num_lanes() == 8 && small.lane_threads[0] == 1);
+    const r1cs_gg_ppzksnark_zok_farm_schedule large(1ul << 20, 16, 8, 1ul << 14);
+    assert(large.num_lanes() == 1 && large.lane_threads[0] == 8);
+    const r1cs_gg_ppzksnark_zok_farm_schedule medium(1ul << 15, 16, 7, 1ul << 14);
+    assert(medium.num_lanes() == 3 && medium.lane_threads[0] == 3 && medium.lane_threads[2] == 2);
+    const r1cs_gg_ppzksnark_zok_farm_schedule short_queue(1000, 3, 8, 1ul << 14);
+    assert(short_queue.num_lanes() == 3 && short_queue.lane_threads[0] == 3 && short_queue.lane_threads[2] == 2);
+    assert(r1cs_gg_ppzksnark_zok_farm_schedule(1000, 0, 8, 1ul << 14).num_lanes() == 0);
+
+    const test_r1cs_gg_ppzksnark_zok_instance<ppT> instance(num_constraints, input_size);
+    const r1cs_example<libff::Fr<ppT> > &example = instance.example;
+
+    const std::vector<r1cs_gg_ppzksnark_zok_primary_input<ppT> > primary_inputs(queue_depth, example.primary_input);
+    const std::vector<r1cs_gg_ppzksnark_zok_auxiliary_input<ppT> > auxiliary_inputs(queue_depth, example.auxiliary_input);
+    std::vector<r1cs_gg_ppzksnark_zok_blinding_factors<ppT> > blinding;
+    for (size_t i = 0; i < queue_depth; ++i)
+    {
+        blinding.emplace_back(r1cs_gg_ppzksnark_zok_blinding_factors<ppT>::from_seed(i));
+    }
+
+    r1cs_gg_ppzksnark_zok_prover_farm<ppT> farm(instance.keypair.pk);
+    const std::vector<r1cs_gg_ppzksnark_zok_proof<ppT> > proofs = farm.prove(primary_inputs, auxiliary_inputs, blinding);
+    assert(proofs.size() == queue_depth);
+    for (size_t i = 0; i < queue_depth; ++i)
+    {
+        assert(proofs[i] == r1cs_gg_ppzksnark_zok_prover<ppT>(instance.keypair.pk, example.primary_input, example.auxiliary_input, blinding[i]));
+    }
+
+    /* One lane with every thread */
+    farm.min_constraints_per_thread = 1;
+    for (const r1cs_gg_ppzksnark_zok_proof<ppT> &proof : farm.prove(primary_inputs, auxiliary_inputs))
+    {
+        assert(instance.verify(proof));
+    }
+    assert(farm.metrics.num_queues == 2 && farm.metrics.num_proofs == 2 * queue_depth);
+    assert(farm.metrics.last_num_lanes == 1);
+
+    libff::print_header("(leave) Test R1CS GG-ppzkSNARK prover farm");
+}
+
+template<typename ppT>
+void test_r1cs_gg_ppzksnark_zok_incremental_prover(size_t num_constraints,
+                                                   size_t input_size)
+{
+    libff::print_header("(enter) Test R1CS GG-ppzkSNARK incremental prover");
+
+    typedef libff::Fr<ppT> FieldT;
+    typedef typename r1cs_gg_ppzksnark_zok_incremental_prover<ppT>::changes_type changes_type;
+
+    /* x_i * x_i = y_i over auxiliary pairs (x_i, y_i), after unconstrained
+       primary inputs: any x_i can change, along with its y_i */
+    r1cs_constraint_system<FieldT> constraint_system;
+    r1cs_primary_input<FieldT> primary_input;
+    r1cs_auxiliary_input<FieldT> auxiliary_input;
+    for (size_t i = 0; i < input_size; ++i)
+    {
+        primary_input.emplace_back(FieldT::random_element());
+    }
+    for (size_t i = 0; i < num_constraints; ++i)
+    {
+        const FieldT x = FieldT::random_element();
+        auxiliary_input.emplace_back(x);
+        auxiliary_input.emplace_back(x * x);
+
+        linear_combination<FieldT> a, b, c;
+        a.add_term(variable<FieldT>(input_size + 2 * i + 1));
+        b.add_term(variable<FieldT>(input_size + 2 * i + 1));
+        c.add_term(variable<FieldT>(input_size + 2 * i + 2));
+        constraint_system.add_constraint(r1cs_constraint<FieldT>(a, b, c));
+    }
+    constraint_system.primary_input_size = input_size;
+    constraint_system.auxiliary_input_size = auxiliary_input.size();
+
+    const r1cs_gg_ppzksnark_zok_keypair<ppT> keypair = r1cs_gg_ppzksnark_zok_generator<ppT>(constraint_system);
+    const r1cs_gg_ppzksnark_zok_blinding_factors<ppT> blinding = r1cs_gg_ppzksnark_zok_blinding_factors<ppT>::from_seed(42);
+
+    r1cs_gg_ppzksnark_zok_incremental_prover<ppT> prover(keypair.pk, primary_input, auxiliary_input);
+    const r1cs_gg_ppzksnark_zok_proof<ppT> proof = prover.prove(changes_type(), blinding);
+    assert(proof == r1cs_gg_ppzksnark_zok_prover<ppT>(keypair.pk, primary_input, auxiliary_input, blinding));
+    assert(prover.last_num_changed == 0);
+
+    /* Three pairs and a primary input, one of them set twice */
+    r1cs_primary_input<FieldT> new_primary_input(primary_input);
+    r1cs_auxiliary_input<FieldT> new_auxiliary_input(auxiliary_input);
+    changes_type changes;
+    for (const size_t i : { (size_t)0, num_constraints / 2, num_constraints - 1 })
+    {
+        const FieldT x = FieldT::random_element();
+        changes.emplace_back(input_size + 2 * i + 1, FieldT::random_element());
+        changes.emplace_back(input_size + 2 * i + 1, x);
+        changes.emplace_back(input_size + 2 * i + 2, x * x);
+        new_auxiliary_input[2 * i] = x;
+        new_auxiliary_input[2 * i + 1] = x * x;
+    }
+    new_primary_input[0] = FieldT::random_element();
+    changes.emplace_back(1, new_primary_input[0]);
+
+    assert(prover.prove(changes, blinding) == r1cs_gg_ppzksnark_zok_prover<ppT>(keypair.pk, new_primary_input, new_auxiliary_input, blinding));
+    assert(prover.last_num_changed == 7);
+    assert(prover.auxiliary_input() == new_auxiliary_input);
+
+    assert(r1cs_gg_ppzksnark_zok_verifier_strong_IC<ppT>(keypair.vk, new_primary_input, prover.prove(changes)));
+    assert(prover.last_num_changed == 0);
+
+    /* The changes of a whole witness are found by comparison */
+    const r1cs_gg_ppzksnark_zok_prover_config pippenger_config(r1cs_gg_ppzksnark_zok_multi_exp_pippenger);
+    r1cs_gg_ppzksnark_zok_incremental_prover<ppT> pippenger_prover(keypair.pk, new_primary_input, new_auxiliary_input, pippenger_config);
+    assert(pippenger_prover.prove(primary_input, auxiliary_input, blinding) == proof);
+    assert(pippenger_prover.last_num_changed == 7);
+
+    /* Neither the constant one nor unknown variables change */
+    assert(test_throws<std::out_of_range>([&]() {
+        prover.prove({ std::make_pair((size_t)0, FieldT::one()) });
+    }));
+    assert(test_throws<std::out_of_range>([&]() {
+        prover.prove({ std::make_pair(input_size + auxiliary_input.size() + 1, FieldT::one()) });
+    }));
+    assert(prover.auxiliary_input() == new_auxiliary_input);
+
+    libff::print_header("(leave) Test R1CS GG-ppzkSNARK incremental prover");
+}
+
+template<typename ppT>
+void test_r1cs_gg_ppzksnark_zok_generator_tasks(size_t num_scalars)
+{
+    libff::print_header("(enter) Test R1CS GG-ppzkSNARK generator tasks");
+
+    typedef libff::Fr<ppT> FieldT;
+    typedef libff::G2<ppT> G2;
+
+    const size_t scalar_size = FieldT::size_in_bits();
+    const size_t window = libff::get_exp_window_size<G2>(num_scalars);
+    const G2 g = G2::random_element();
+
+    /* The same tables and exponentiations as libff's */
+    const libff::window_table<G2> table = r1cs_gg_ppzksnark_zok_window_table(scalar_size, window, g, 4);
+    assert(table == libff::get_window_table(scalar_size, window, g));
+
+    std::vector<FieldT> scalars(num_scalars);
+    for (auto &scalar : scalars)
+    {
+        scalar = FieldT::random_element();
+    }
+    const FieldT coeff = FieldT::random_element();
+
+    std::vector<G2> result(num_scalars);
+    r1cs_gg_ppzksnark_zok_progress progress("Exponentiations", num_scalars);
+    r1cs_gg_ppzksnark_zok_batch_exp(scalar_size, window, table, coeff, scalars.begin(), num_scalars,
+                                    [&](const size_t i) -> G2& { return result[i]; },
+                                    progress, 4);
+    assert(result == libff::batch_exp_with_coeff(scalar_size, window, table, coeff, scalars));
+
+    libff::print_header("(leave) Test R1CS GG-ppzkSNARK generator tasks");
+}
+
 int main()
 {
     default_r1cs_gg_ppzksnark_zok_pp::init_public_params();
     libff::start_profiling();
 
     test_r1cs_gg_ppzksnark_zok<default_r1cs_gg_ppzksnark_zok_pp>(1000, 100);
+    test_r1cs_gg_ppzksnark_zok_constraint_matrices<default_r1cs_gg_ppzksnark_zok_pp>(1000, 100);
+    test_r1cs_gg_ppzksnark_zok_generator_tasks<default_r1cs_gg_ppzksnark_zok_pp>(10000);
+    test_r1cs_gg_ppzksnark_zok_evaluation_domain<default_r1cs_gg_ppzksnark_zok_pp>(1ul << 11);
+    test_r1cs_gg_ppzksnark_zok_evaluation_domain<default_r1cs_gg_ppzksnark_zok_pp>(1ul << 16);
+    test_r1cs_gg_ppzksnark_zok_prover_context<default_r1cs_gg_ppzksnark_zok_pp>(1000, 100, 2);
+    test_r1cs_gg_ppzksnark_zok_processed_verification_key<default_r1cs_gg_ppzksnark_zok_pp>(1000, 100);
+    test_r1cs_gg_ppzksnark_zok_batch_prover<default_r1cs_gg_ppzksnark_zok_pp>(1000, 100, 3);
+    test_r1cs_gg_ppzksnark_zok_pippenger<default_r1cs_gg_ppzksnark_zok_pp>(1000, 100);
+    test_r1cs_gg_ppzksnark_zok_glv<default_r1cs_gg_ppzksnark_zok_pp>(100);
+    test_r1cs_gg_ppzksnark_zok_batch_affine<default_r1cs_gg_ppzksnark_zok_pp>(1ul << 15);
+    test_r1cs_gg_ppzksnark_zok_expanded_proving_key<default_r1cs_gg_ppzksnark_zok_pp>(1000, 100, 0);
+    test_r1cs_gg_ppzksnark_zok_expanded_proving_key<default_r1cs_gg_ppzksnark_zok_pp>(1000, 100, 1ul << 24);
+    test_r1cs_gg_ppzksnark_zok_streaming_prover<default_r1cs_gg_ppzksnark_zok_pp>(1000, 100, 4096);
+    test_r1cs_gg_ppzksnark_zok_streaming_generator<default_r1cs_gg_ppzksnark_zok_pp>(1000, 100, 4096);
+    test_r1cs_gg_ppzksnark_zok_mapped_proving_key<default_r1cs_gg_ppzksnark_zok_pp>(1000, 100);
+    test_r1cs_gg_ppzksnark_zok_prover_farm<default_r1cs_gg_ppzksnark_zok_pp>(1000, 100, 5);
+    test_r1cs_gg_ppzksnark_zok_incremental_prover<default_r1cs_gg_ppzksnark_zok_pp>(1000, 100);
+    test_r1cs_gg_ppzksnark_zok_deterministic_prover<default_r1cs_gg_ppzksnark_zok_pp>(1000, 100);
 }
@@ -3,13 +3,18 @@
 
 #include <libsnark/gadgetlib1/protoboard.hpp>
 
+#include <fstream>  // ifstream
 #include <sstream>  // stringstream
+#include <stdexcept>  // runtime_error
 
 #include "utils.hpp"
 #include "import.hpp"
 #include "export.hpp"
 
 #include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok.hpp"
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_farm.hpp"
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_mapped.hpp"
+#include "r1cs_gg_ppzksnark_zok/r1cs_gg_ppzksnark_zok_streaming.hpp"
 
 namespace ethsnarks {
 
@@ -21,11 +26,17 @@ bool stub_verify( const char *vk_json, const char *proof_json )
     vk_stream << vk_json;
     auto vk = vk_from_json(vk_stream);
 
+    return stub_verify(libsnark::r1cs_gg_ppzksnark_zok_verifier_process_vk<ppT>(vk), proof_json);
+}
+
+
+bool stub_verify( const ProcessedVerificationKeyT& pvk, const char *proof_json )
+{
     std::stringstream proof_stream;
     proof_stream << proof_json;
     auto proof_pair = proof_from_json(proof_stream);
 
-    auto status = libsnark::r1cs_gg_ppzksnark_zok_verifier_strong_IC <ppT> (vk, proof_pair.first, proof_pair.second);
+    auto status = libsnark::r1cs_gg_ppzksnark_zok_online_verifier_strong_IC <ppT> (pvk, proof_pair.first, proof_pair.second);
     if( status )
         return true;
 
@@ -38,16 +49,144 @@ std::string stub_prove_from_pb( ProtoboardT& pb, const char *pk_file )
     auto proving_key = ethsnarks::loadFromFile<ethsnarks::ProvingKeyT>(pk_file);
     // TODO: verify if proving key was loaded correctly, if not return NULL
 
+    return stub_prove_from_pb(pb, proving_key);
+}
+
+
+std::string stub_prove_from_pb( ProtoboardT& pb, const ProvingKeyT& proving_key )
+{
     auto primary_input = pb.primary_input();
     auto proof = libsnark::r1cs_gg_ppzksnark_zok_prover<ethsnarks::ppT>(proving_key, primary_input, pb.auxiliary_input());
     return ethsnarks::proof_to_json(proof, primary_input);
 }
 
 
+std::string stub_prove_streaming_from_pb( ProtoboardT& pb, const char *pk_file, size_t buffer_size )
+{
+    std::ifstream pk_input(pk_file, std::ios::binary);
+    if( ! pk_input ) {
+        std::cerr << "Error: cannot open " << pk_file << std::endl;
+        throw std::runtime_error(std::string("cannot open ") + pk_file);
+    }
+
+    auto primary_input = pb.primary_input();
+    auto proof = libsnark::r1cs_gg_ppzksnark_zok_streaming_prover<ppT>(pk_input, primary_input, pb.auxiliary_input(), buffer_size);
+    return ethsnarks::proof_to_json(proof, primary_input);
+}
+
+
+// Splits the protoboards into inputs, proves them all with `prove` and
+// converts each proof to JSON, in the order of the protoboards
+template<typename ProverT>
+static std::vector<std::string> stub_prove_many_from_pb( const std::vector<ProtoboardT>& pbs, ProverT prove )
+{
+    std::vector<PrimaryInputT> primary_inputs;
+    std::vector<AuxiliaryInputT> auxiliary_inputs;
+    primary_inputs.reserve(pbs.size());
+    auxiliary_inputs.reserve(pbs.size());
+
+    for( const auto& pb : pbs )
+    {
+        primary_inputs.emplace_back(pb.primary_input());
+        auxiliary_inputs.emplace_back(pb.auxiliary_input());
+    }
+
+    auto proofs = prove(primary_inputs, auxiliary_inputs);
+
+    std::vector<std::string> result;
+    result.reserve(proofs.size());
+
+    for( size_t i = 0; i < proofs.size(); i++ )
+    {
+        result.emplace_back(proof_to_json(proofs[i], primary_inputs[i]));
+    }
+
+    return result;
+}
+
+
+std::vector<std::string> stub_prove_batch_from_pb( const std::vector<ProtoboardT>& pbs, const char *pk_file )
+{
+    auto proving_key = ethsnarks::loadFromFile<ethsnarks::ProvingKeyT>(pk_file);
+
+    return stub_prove_many_from_pb(pbs,
+        [&proving_key]( const std::vector<PrimaryInputT>& primary_inputs, const std::vector<AuxiliaryInputT>& auxiliary_inputs ) {
+            return libsnark::r1cs_gg_ppzksnark_zok_batch_prover<ppT>(proving_key, primary_inputs, auxiliary_inputs);
+        });
+}
+
+
+std::vector<std::string> stub_prove_farm_from_pb( const std::vector<ProtoboardT>& pbs, const char *pk_file )
+{
+    auto proving_key = ethsnarks::loadFromFile<ethsnarks::ProvingKeyT>(pk_file);
+    libsnark::r1cs_gg_ppzksnark_zok_prover_farm<ppT> farm(proving_key);
+
+    return stub_prove_many_from_pb(pbs,
+        [&farm]( const std::vector<PrimaryInputT>& primary_inputs, const std::vector<AuxiliaryInputT>& auxiliary_inputs ) {
+            return farm.prove(primary_inputs, auxiliary_inputs);
+        });
+}
+
+
+
+int stub_write_mapped_pk( const char *pk_file, const char *mapped_pk_file )
+{
+    auto proving_key = ethsnarks::loadFromFile<ethsnarks::ProvingKeyT>(pk_file);
+
+    std::ofstream out(mapped_pk_file, std::ios::binary);
+    if( ! out ) {
+        std::cerr << "Error: cannot open " << mapped_pk_file << std::endl;
+        return 2;
+    }
+
+    libsnark::r1cs_gg_ppzksnark_zok_write_mapped_proving_key<ppT>(proving_key, out);
+
+    return 0;
+}
+
+
+std::string stub_prove_mapped_from_pb( ProtoboardT& pb, const char *mapped_pk_file )
+{
+    const libsnark::r1cs_gg_ppzksnark_zok_mapped_proving_key<ppT> proving_key(mapped_pk_file);
+    libsnark::r1cs_gg_ppzksnark_zok_prover_workspace<ppT> workspace(proving_key.context);
+
+    auto primary_input = pb.primary_input();
+    auto proof = libsnark::r1cs_gg_ppzksnark_zok_prover<ppT>(proving_key, workspace, primary_input, pb.auxiliary_input());
+    return ethsnarks::proof_to_json(proof, primary_input);
+}
+
+
 int stub_genkeys_from_pb( ProtoboardT& pb, const char *pk_file, const char *vk_file )
 {
-    const auto constraints = pb.get_constraint_system();
-    auto keypair = libsnark::r1cs_gg_ppzksnark_zok_generator<ppT>(constraints);
+    return stub_genkeys_from_cs(pb.get_constraint_system(), pk_file, vk_file);
+}
+
+
+int stub_genkeys_from_cs( ConstraintSystemT&& constraints, const char *pk_file, const char *vk_file, bool drop_annotations )
+{
+    // Only debug builds keep annotations, release builds have none to drop
+    size_t dropped_constraint_annotations = 0;
+    size_t dropped_variable_annotations = 0;
+#ifdef DEBUG
+    if( drop_annotations )
+    {
+        dropped_constraint_annotations = constraints.constraint_annotations.size();
+        dropped_variable_annotations = constraints.variable_annotations.size();
+        constraints.constraint_annotations.clear();
+        constraints.variable_annotations.clear();
+    }
+#else
+    libff::UNUSED(drop_annotations);
+#endif
+
+    if( ! libff::inhibit_profiling_info )
+    {
+        libff::print_indent();
+        printf("* Dropped annotations: %zu constraints, %zu variables\n",
+               dropped_constraint_annotations, dropped_variable_annotations);
+    }
+
+    auto keypair = libsnark::r1cs_gg_ppzksnark_zok_generator<ppT>(std::move(constraints));
     vk2json_file(keypair.vk, vk_file);
     writeToFile<decltype(keypair.pk)>(pk_file, keypair.pk);
 
@@ -55,6 +194,21 @@ int stub_genkeys_from_pb( ProtoboardT& pb, const char *pk_file, const char *vk_f
 }
 
 
+int stub_genkeys_streaming_from_pb( ProtoboardT& pb, const char *pk_file, const char *vk_file, size_t buffer_size )
+{
+    std::ofstream pk_output(pk_file, std::ios::binary);
+    if( ! pk_output ) {
+        std::cerr << "Error: cannot open " << pk_file << std::endl;
+        return 2;
+    }
+
+    auto vk = libsnark::r1cs_gg_ppzksnark_zok_streaming_generator<ppT>(pb.get_constraint_system(), pk_output, buffer_size);
+    vk2json_file(vk, vk_file);
+
+    return 0;
+}
+
+
 int stub_main_verify( const char *prog_name, int argc, const char **argv )
 {
     if( argc < 3 )
@@ -8,25 +8,86 @@ namespace ethsnarks {
 
 bool stub_verify( const char *vk_json, const char *proof_json );
 
+/**
+* Verify against a verification key processed once with
+* r1cs_gg_ppzksnark_zok_verifier_process_vk, for callers checking many
+* proofs against the same key.
+*/
+bool stub_verify( const ProcessedVerificationKeyT& pvk, const char *proof_json );
+
 int stub_main_verify( const char *prog_name, int argc, const char **argv );
 
 bool stub_test_proof_verify( const ProtoboardT &in_pb );
 
 int stub_genkeys_from_pb( ProtoboardT& pb, const char *pk_file, const char *vk_file );
 
+/**
+* Generate keys from the constraint system alone, which is consumed: no
+* assignment is needed and its satisfaction is not checked. With
+* drop_annotations the constraint and variable annotations kept by debug
+* builds are released before the generator runs. The skipped work is
+* printed with the generator's profiling.
+*/
+int stub_genkeys_from_cs( ConstraintSystemT&& constraints, const char *pk_file, const char *vk_file, bool drop_annotations = true );
+
+/**
+* Generate keys writing the proving key to disk as it is computed, at most
+* buffer_size bytes of the key's points are held in memory at once.
+*/
+int stub_genkeys_streaming_from_pb( ProtoboardT& pb, const char *pk_file, const char *vk_file, size_t buffer_size );
+
 std::string stub_prove_from_pb( ProtoboardT& pb, const char *pk_file );
 
+std::string stub_prove_from_pb( ProtoboardT& pb, const ProvingKeyT& proving_key );
+
+/**
+* Prove with the proving key read from disk section by section, at most
+* buffer_size bytes of the key's points are held in memory at once. Throws
+* if pk_file cannot be opened or does not hold a valid key.
+*/
+std::string stub_prove_streaming_from_pb( ProtoboardT& pb, const char *pk_file, size_t buffer_size );
+
+/**
+* Prove many protoboards against one proving key, the key is loaded once
+* and the query evaluations for all of the witnesses are computed together.
+*/
+std::vector<std::string> stub_prove_batch_from_pb( const std::vector<ProtoboardT>& pbs, const char *pk_file );
+
+/**
+* Prove many protoboards against one proving key, running as many proofs at
+* once as the size of the circuit and the number of protoboards allow, see
+* r1cs_gg_ppzksnark_zok_farm.hpp
+*/
+std::vector<std::string> stub_prove_farm_from_pb( const std::vector<ProtoboardT>& pbs, const char *pk_file );
+
+/**
+* Write the proving key in pk_file to mapped_pk_file in the memory-mapped
+* format, which processes proving with it share rather than parse.
+*/
+int stub_write_mapped_pk( const char *pk_file, const char *mapped_pk_file );
+
+/**
+* Prove with a proving key mapped read-only from a file written by
+* stub_write_mapped_pk, the queries are read in place.
+*/
+std::string stub_prove_mapped_from_pb( ProtoboardT& pb, const char *mapped_pk_file );
+
 
 template<class GadgetT>
 int stub_genkeys( const char *pk_file, const char *vk_file )
 {
     ppT::init_public_params();
 
-    ProtoboardT pb;
-    GadgetT mod(pb, "module");
-    mod.generate_r1cs_constraints();
+    // The protoboard and gadget are released before the keys are generated
+    ConstraintSystemT constraints;
+    {
+        ProtoboardT pb;
+        GadgetT mod(pb, "module");
+        mod.generate_r1cs_constraints();
+        constraints = pb.get_constraint_system();
+    }
 
-    return stub_genkeys_from_pb(pb, pk_file, vk_file);
+    return stub_genkeys_from_cs(std::move(constraints), pk_file, vk_file);
 }
 
 
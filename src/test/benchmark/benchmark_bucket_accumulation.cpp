@@ -0,0 +1,79 @@
+#include <cassert>
+#include <cstdio>
+
+#include <libff/common/profiling.hpp>
+
+#ifdef MULTICORE
+#include <omp.h>
+#endif
+
+#include "utils.hpp"
+#include "ethsnarks.hpp"
+
+/*
+* Compares the two ways the Pippenger multi-exponentiation accumulates its
+* buckets, Jacobian buckets with mixed additions and affine buckets with
+* batched inversions, on the H and L queries of a proving key.
+*
+* The key should be built with USE_MIXED_ADDITION, so its bases are affine.
+*/
+
+using ethsnarks::ppT;
+using ethsnarks::FieldT;
+using ethsnarks::G1T;
+using ethsnarks::ProvingKeyT;
+using ethsnarks::loadFromFile;
+
+
+static void benchmark_g1_query( const char *name, const std::vector<G1T> &query, size_t chunks )
+{
+    std::vector<libff::bigint<FieldT::num_limbs> > exponents(query.size());
+    for( auto &x : exponents ) {
+        x = FieldT::random_element().as_bigint();
+    }
+
+    const libsnark::pippenger_vector_accessor<G1T> bases(query.begin());
+
+    long long start = libff::get_nsec_time();
+    const G1T expected = libsnark::pippenger_multi_exp_bigint_method<G1T, libsnark::pippenger_bucket_jacobian>(
+        bases, exponents, chunks);
+    const long long jacobian_nsec = libff::get_nsec_time() - start;
+
+    start = libff::get_nsec_time();
+    const G1T result = libsnark::pippenger_multi_exp_bigint_method<G1T, libsnark::pippenger_bucket_batch_affine>(
+        bases, exponents, chunks);
+    const long long affine_nsec = libff::get_nsec_time() - start;
+
+    assert( result == expected );
+    libff::UNUSED(expected, result);
+
+    printf("%-8s %10zu bases   window %2zu   mixed %10.2f ms   batch affine %10.2f ms   speedup %.2fx\n",
+           name, query.size(), libsnark::pippenger_window_size(query.size(), FieldT::size_in_bits()),
+           jacobian_nsec / 1e6, affine_nsec / 1e6,
+           (double)jacobian_nsec / (double)affine_nsec);
+}
+
+
+int main( int argc, char **argv )
+{
+    ppT::init_public_params();
+    libff::inhibit_profiling_info = true;
+
+    if( argc < 2 ) {
+        std::cerr << "Usage: " << argv[0] << " <proofkey.raw>\n";
+        return 1;
+    }
+
+    const ProvingKeyT pk = loadFromFile<ProvingKeyT>(argv[1]);
+
+#ifdef MULTICORE
+    const size_t chunks = omp_get_max_threads();
+#else
+    const size_t chunks = 1;
+#endif
+
+    benchmark_g1_query("H", pk.H_query, chunks);
+    benchmark_g1_query("L", pk.L_query, chunks);
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+
+#include <libff/common/profiling.hpp>
+#include <libfqfft/evaluation_domain/get_evaluation_domain.hpp>
+
+#ifdef MULTICORE
+#include <omp.h>
+#endif
+
+#include "ethsnarks.hpp"
+
+/*
+* Compares the libfqfft radix-2 domain against the cached radix-4 domain used
+* by the prover to compute H, for the transforms done by the witness map.
+*
+* Usage: benchmark_fft [min_log_size] [max_log_size]
+*/
+
+using ethsnarks::ppT;
+using ethsnarks::FieldT;
+
+
+static void print_result( const char *name, size_t log_size, long long libfqfft_nsec, long long radix4_nsec )
+{
+    printf("%-10s 2^%-2zu   libfqfft %10.2f ms   radix-4 %10.2f ms   speedup %.2fx\n",
+           name, log_size, libfqfft_nsec / 1e6, radix4_nsec / 1e6,
+           (double)libfqfft_nsec / (double)radix4_nsec);
+}
+
+
+static void benchmark_size( size_t log_size )
+{
+    const size_t n = 1ul << log_size;
+
+    const auto reference = libfqfft::get_evaluation_domain<FieldT>(n);
+
+    long long start = libff::get_nsec_time();
+    const libsnark::qap_evaluation_domain<FieldT> domain(n, true);
+    const long long tables_nsec = libff::get_nsec_time() - start;
+
+    printf("2^%zu: tables of %zu bytes computed in %.2f ms\n",
+           log_size, domain.tables_size_in_bytes(), tables_nsec / 1e6);
+
+    std::vector<FieldT> input(n);
+    for( auto &x : input ) {
+        x = FieldT::random_element();
+    }
+
+    std::vector<FieldT> expected(input);
+    start = libff::get_nsec_time();
+    reference->FFT(expected);
+    long long libfqfft_nsec = libff::get_nsec_time() - start;
+
+    std::vector<FieldT> result(input);
+    start = libff::get_nsec_time();
+    domain.FFT(result);
+    long long radix4_nsec = libff::get_nsec_time() - start;
+
+    assert( result == expected );
+    print_result("FFT", log_size, libfqfft_nsec, radix4_nsec);
+
+    expected = input;
+    start = libff::get_nsec_time();
+    reference->iFFT(expected);
+    libfqfft_nsec = libff::get_nsec_time() - start;
+
+    result = input;
+    start = libff::get_nsec_time();
+    domain.iFFT(result);
+    radix4_nsec = libff::get_nsec_time() - start;
+
+    assert( result == expected );
+    print_result("iFFT", log_size, libfqfft_nsec, radix4_nsec);
+
+    expected = input;
+    start = libff::get_nsec_time();
+    reference->cosetFFT(expected, FieldT::multiplicative_generator);
+    libfqfft_nsec = libff::get_nsec_time() - start;
+
+    result = input;
+    start = libff::get_nsec_time();
+    domain.cosetFFT(result);
+    radix4_nsec = libff::get_nsec_time() - start;
+
+    assert( result == expected );
+    print_result("cosetFFT", log_size, libfqfft_nsec, radix4_nsec);
+
+    expected = input;
+    start = libff::get_nsec_time();
+    reference->icosetFFT(expected, FieldT::multiplicative_generator);
+    libfqfft_nsec = libff::get_nsec_time() - start;
+
+    result = input;
+    start = libff::get_nsec_time();
+    domain.icosetFFT(result);
+    radix4_nsec = libff::get_nsec_time() - start;
+
+    assert( result == expected );
+    print_result("icosetFFT", log_size, libfqfft_nsec, radix4_nsec);
+}
+
+
+int main( int argc, char **argv )
+{
+    ppT::init_public_params();
+    libff::inhibit_profiling_info = true;
+
+    const size_t min_log_size = argc > 1 ? atoi(argv[1]) : 16;
+    const size_t max_log_size = argc > 2 ? atoi(argv[2]) : 22;
+
+    if( min_log_size == 0 || min_log_size > max_log_size || max_log_size > FieldT::s ) {
+        std::cerr << "Usage: " << argv[0] << " [min_log_size] [max_log_size <= " << FieldT::s << "]\n";
+        return 1;
+    }
+
+#ifdef MULTICORE
+    printf("%d threads\n", omp_get_max_threads());
+#endif
+
+    for( size_t log_size = min_log_size; log_size <= max_log_size; log_size++ )
+    {
+        benchmark_size(log_size);
+    }
+
+    return 0;
+}
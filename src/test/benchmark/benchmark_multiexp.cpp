@@ -0,0 +1,108 @@
+#include <cassert>
+#include <cstdio>
+
+#include <libff/common/profiling.hpp>
+
+#ifdef MULTICORE
+#include <omp.h>
+#endif
+
+#include "utils.hpp"
+#include "ethsnarks.hpp"
+
+/*
+* Compares libff's BDLO12 multi-exponentiation against the Pippenger
+* implementation used by the prover, for each query of a proving key.
+*
+* Scalars are random field elements, sized to match each query.
+*/
+
+using ethsnarks::ppT;
+using ethsnarks::FieldT;
+using ethsnarks::G1T;
+using ethsnarks::G2T;
+using ethsnarks::ProvingKeyT;
+using ethsnarks::loadFromFile;
+
+
+static void print_result( const char *name, size_t length, long long bdlo12_nsec, long long pippenger_nsec )
+{
+    printf("%-8s %10zu bases   BDLO12 %10.2f ms   Pippenger %10.2f ms   speedup %.2fx\n",
+           name, length, bdlo12_nsec / 1e6, pippenger_nsec / 1e6,
+           (double)bdlo12_nsec / (double)pippenger_nsec);
+}
+
+
+static void benchmark_g1_query( const char *name, const std::vector<G1T> &query, size_t chunks )
+{
+    std::vector<FieldT> scalars(query.size());
+    for( auto &x : scalars ) {
+        x = FieldT::random_element();
+    }
+
+    long long start = libff::get_nsec_time();
+    const G1T expected = libff::multi_exp_with_mixed_addition<G1T, FieldT, libff::multi_exp_method_BDLO12>(
+        query.begin(), query.end(), scalars.begin(), scalars.end(), chunks);
+    const long long bdlo12_nsec = libff::get_nsec_time() - start;
+
+    start = libff::get_nsec_time();
+    const G1T result = libsnark::pippenger_multi_exp<G1T, FieldT>(
+        query.begin(), query.end(), scalars.begin(), scalars.end(), chunks);
+    const long long pippenger_nsec = libff::get_nsec_time() - start;
+
+    assert( result == expected );
+    libff::UNUSED(expected, result);
+
+    print_result(name, query.size(), bdlo12_nsec, pippenger_nsec);
+}
+
+
+static void benchmark_B_query( const libsnark::knowledge_commitment_vector<G2T, G1T> &query, size_t chunks )
+{
+    std::vector<FieldT> scalars(query.domain_size());
+    for( auto &x : scalars ) {
+        x = FieldT::random_element();
+    }
+
+    long long start = libff::get_nsec_time();
+    const auto expected = libsnark::kc_multi_exp_with_mixed_addition<G2T, G1T, FieldT, libff::multi_exp_method_BDLO12>(
+        query, 0, query.domain_size(), scalars.begin(), scalars.end(), chunks);
+    const long long bdlo12_nsec = libff::get_nsec_time() - start;
+
+    start = libff::get_nsec_time();
+    const auto result = libsnark::kc_pippenger_multi_exp<G2T, G1T, FieldT>(
+        query, 0, query.domain_size(), scalars.begin(), scalars.end(), chunks);
+    const long long pippenger_nsec = libff::get_nsec_time() - start;
+
+    assert( result == expected );
+    libff::UNUSED(expected, result);
+
+    print_result("B", query.size(), bdlo12_nsec, pippenger_nsec);
+}
+
+
+int main( int argc, char **argv )
+{
+    ppT::init_public_params();
+    libff::inhibit_profiling_info = true;
+
+    if( argc < 2 ) {
+        std::cerr << "Usage: " << argv[0] << " <proofkey.raw>\n";
+        return 1;
+    }
+
+    const ProvingKeyT pk = loadFromFile<ProvingKeyT>(argv[1]);
+
+#ifdef MULTICORE
+    const size_t chunks = omp_get_max_threads();
+#else
+    const size_t chunks = 1;
+#endif
+
+    benchmark_g1_query("A", pk.A_query, chunks);
+    benchmark_B_query(pk.B_query, chunks);
+    benchmark_g1_query("H", pk.H_query, chunks);
+    benchmark_g1_query("L", pk.L_query, chunks);
+
+    return 0;
+}
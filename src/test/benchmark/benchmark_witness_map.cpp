@@ -0,0 +1,159 @@
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+
+#include <libff/common/profiling.hpp>
+#include <libsnark/reductions/r1cs_to_qap/r1cs_to_qap.hpp>
+
+#ifdef MULTICORE
+#include <omp.h>
+#endif
+
+#include "ethsnarks.hpp"
+#include "utils.hpp"
+#include "gadgets/merkle_tree.hpp"
+#include "gadgets/mimc.hpp"
+
+/*
+* Compares evaluating the constraints through libsnark's linear_combination
+* objects against the CSR constraint matrices stored in the proving key, on
+* a circuit made of MiMC Merkle path authenticators.
+*
+* Usage: benchmark_witness_map [num_paths] [tree_depth]
+*/
+
+using ethsnarks::ppT;
+using ethsnarks::FieldT;
+using ethsnarks::ProtoboardT;
+using ethsnarks::VariableT;
+using ethsnarks::VariableArrayT;
+using ethsnarks::MiMC_hash_gadget;
+using ethsnarks::merkle_path_authenticator;
+using ethsnarks::merkle_tree_IVs;
+using ethsnarks::make_variable;
+using ethsnarks::make_var_array;
+
+
+static void print_result( const char *name, long long lc_nsec, long long csr_nsec )
+{
+    printf("%-32s linear_combination %10.2f ms   CSR %10.2f ms   speedup %.2fx\n",
+           name, lc_nsec / 1e6, csr_nsec / 1e6,
+           (double)lc_nsec / (double)csr_nsec);
+}
+
+
+static void build_merkle_circuit( ProtoboardT &pb, size_t num_paths, size_t tree_depth )
+{
+    // The expected roots are the public inputs
+    const VariableArrayT roots = make_var_array(pb, num_paths, "roots");
+    pb.set_input_sizes(num_paths);
+
+    const VariableArrayT IVs = merkle_tree_IVs(pb);
+    std::vector<merkle_path_authenticator<MiMC_hash_gadget>> authenticators;
+    authenticators.reserve(num_paths);
+
+    for( size_t i = 0; i < num_paths; i++ )
+    {
+        const VariableArrayT address_bits = make_var_array(pb, tree_depth, FMT("path", "[%zu].address_bits", i));
+        const VariableArrayT path = make_var_array(pb, tree_depth, FMT("path", "[%zu].path", i));
+        const VariableT leaf = make_variable(pb, FMT("path", "[%zu].leaf", i));
+
+        for( size_t j = 0; j < tree_depth; j++ )
+        {
+            pb.val(address_bits[j]) = rand() & 1;
+            pb.val(path[j]) = FieldT::random_element();
+        }
+        pb.val(leaf) = FieldT::random_element();
+
+        authenticators.emplace_back(pb, tree_depth, address_bits, IVs, leaf, roots[i], path, FMT("path", "[%zu]", i));
+        authenticators.back().generate_r1cs_constraints();
+        authenticators.back().generate_r1cs_witness();
+        pb.val(roots[i]) = pb.val(authenticators.back().result());
+    }
+
+    assert( pb.is_satisfied() );
+}
+
+
+int main( int argc, char **argv )
+{
+    ppT::init_public_params();
+    libff::inhibit_profiling_info = true;
+
+    const size_t num_paths = argc > 1 ? atoi(argv[1]) : 16;
+    const size_t tree_depth = argc > 2 ? atoi(argv[2]) : 29;
+
+    if( num_paths == 0 || tree_depth == 0 || tree_depth > 29 ) {
+        std::cerr << "Usage: " << argv[0] << " [num_paths] [tree_depth <= 29]\n";
+        return 1;
+    }
+
+#ifdef MULTICORE
+    const size_t chunks = omp_get_max_threads();
+#else
+    const size_t chunks = 1;
+#endif
+
+    ProtoboardT pb;
+    build_merkle_circuit(pb, num_paths, tree_depth);
+
+    const auto cs = pb.get_constraint_system();
+    const auto primary_input = pb.primary_input();
+    const auto auxiliary_input = pb.auxiliary_input();
+
+    long long start = libff::get_nsec_time();
+    const libsnark::r1cs_gg_ppzksnark_zok_constraint_matrices<ppT> matrices(cs);
+    const long long build_nsec = libff::get_nsec_time() - start;
+
+    printf("%zu paths of depth %zu: %zu constraints, %zu variables, %zu threads\n",
+           num_paths, tree_depth, cs.num_constraints(), cs.num_variables(), chunks);
+    printf("CSR matrices: %zu non-zero terms, %zu bytes, built in %.2f ms\n",
+           matrices.A.num_nonzero() + matrices.B.num_nonzero() + matrices.C.num_nonzero(),
+           matrices.size_in_bytes(), build_nsec / 1e6);
+
+    // Per-constraint evaluations of A, B and C, as done on set S by the witness map
+    std::vector<FieldT> full_variable_assignment(primary_input);
+    full_variable_assignment.insert(full_variable_assignment.end(), auxiliary_input.begin(), auxiliary_input.end());
+
+    std::vector<FieldT> z(1, FieldT::one());
+    z.insert(z.end(), full_variable_assignment.begin(), full_variable_assignment.end());
+
+    const size_t num_constraints = cs.num_constraints();
+    std::vector<FieldT> lc_a(num_constraints), lc_b(num_constraints), lc_c(num_constraints);
+    std::vector<FieldT> csr_a(num_constraints), csr_b(num_constraints), csr_c(num_constraints);
+
+    start = libff::get_nsec_time();
+    for( size_t i = 0; i < num_constraints; i++ )
+    {
+        lc_a[i] = cs.constraints[i].a.evaluate(full_variable_assignment);
+        lc_b[i] = cs.constraints[i].b.evaluate(full_variable_assignment);
+        lc_c[i] = cs.constraints[i].c.evaluate(full_variable_assignment);
+    }
+    const long long lc_eval_nsec = libff::get_nsec_time() - start;
+
+    start = libff::get_nsec_time();
+    matrices.A.multiply(z, csr_a.begin(), chunks);
+    matrices.B.multiply(z, csr_b.begin(), chunks);
+    matrices.C.multiply(z, csr_c.begin(), chunks);
+    const long long csr_eval_nsec = libff::get_nsec_time() - start;
+
+    assert( lc_a == csr_a && lc_b == csr_b && lc_c == csr_c );
+
+    print_result("A, B, C evaluations", lc_eval_nsec, csr_eval_nsec);
+
+    // Whole witness map, including the FFTs
+    start = libff::get_nsec_time();
+    const auto expected = libsnark::r1cs_to_qap_witness_map(cs, primary_input, auxiliary_input, FieldT::zero(), FieldT::zero(), FieldT::zero());
+    const long long lc_map_nsec = libff::get_nsec_time() - start;
+
+    start = libff::get_nsec_time();
+    const auto result = libsnark::r1cs_csr_to_qap_witness_map(matrices, primary_input, auxiliary_input);
+    const long long csr_map_nsec = libff::get_nsec_time() - start;
+
+    assert( result.coefficients_for_H == expected.coefficients_for_H );
+    libff::UNUSED(expected, result);
+
+    print_result("QAP witness map", lc_map_nsec, csr_map_nsec);
+
+    return 0;
+}